@@ -0,0 +1,37 @@
+#include "analysis.h"
+
+#include "tt.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+std::vector<SearchResult> analyzeBatch(const BoardState* positions, size_t count, const SearchLimits& limits,
+                                       const Evaluator& evaluator, const AnalysisOptions& options) {
+    std::vector<SearchResult> results(count);
+    int threadCount = static_cast<int>(std::min<size_t>(std::max(1, options.threads), count));
+    if (!threadCount) return results;
+    size_t shardMB = std::max<size_t>(1, options.hashMB / threadCount);
+    std::atomic<size_t> next{ 0 };
+
+    auto worker = [&]() {
+        std::unique_ptr<Evaluator> eval = evaluator.clone();
+        TranspositionTable tt(shardMB, options.largePages);
+        auto search = std::make_unique<Search>(*eval, tt);
+        search->setFeatures(options.features);
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < count;) {
+            if (options.clearHash) {
+                tt.clear();
+                search->clearHistory();
+            }
+            results[i] = search->think(positions[i], limits);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < threadCount; ++t) threads.emplace_back(worker);
+    worker();
+    for (std::thread& t : threads) t.join();
+    return results;
+}
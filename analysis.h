@@ -0,0 +1,30 @@
+#pragma once
+
+#include "boardstate.h"
+#include "evaluate.h"
+#include "search.h"
+
+#include <cstddef>
+#include <vector>
+
+struct AnalysisOptions {
+    int threads = 1;
+    size_t hashMB = 16;        // in total, split into one table per thread
+    bool largePages = false;
+    // Clears a thread's table and history before each position, so every
+    // result is independent of which thread analysed what before it.
+    bool clearHash = true;
+    SearchFeatures features;
+};
+
+// Analyses independent positions in parallel. Each thread owns a clone of
+// the evaluator, one Search and its own shard of the hash, all reused from
+// position to position, and claims the next position from a shared counter.
+// limits apply to every position; results come back in input order.
+std::vector<SearchResult> analyzeBatch(const BoardState* positions, size_t count, const SearchLimits& limits,
+                                       const Evaluator& evaluator, const AnalysisOptions& options = {});
+
+inline std::vector<SearchResult> analyzeBatch(const std::vector<BoardState>& positions, const SearchLimits& limits,
+                                              const Evaluator& evaluator, const AnalysisOptions& options = {}) {
+    return analyzeBatch(positions.data(), positions.size(), limits, evaluator, options);
+}
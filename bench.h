@@ -0,0 +1,17 @@
+#pragma once
+
+#include "evaluate.h"
+#include "search.h"
+
+#include <cstddef>
+#include <cstdint>
+
+constexpr int DefaultBenchDepth = 10;
+
+// Searches the built-in bench positions one after another, single-threaded
+// and each from an empty hash, printing per-position and total node counts
+// and nodes/sec. The total node count is a signature of the search: builds
+// that differ only in compiler, flags or target must reproduce it exactly.
+// Returns the total.
+uint64_t runBench(const Evaluator& evaluator, int depth = DefaultBenchDepth, size_t hashMB = 16,
+                  const SearchFeatures& features = {});
@@ -0,0 +1,119 @@
+#include "bitboard.h"
+
+Magic RookMagics[64];
+Magic BishopMagics[64];
+Bitboard BetweenBB[64][64];
+Bitboard LineBB[64][64];
+
+namespace {
+
+constexpr int RookDirs[4][2] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+constexpr int BishopDirs[4][2] = { {1, 1}, {1, -1}, {-1, 1}, {-1, -1} };
+
+Bitboard slidingAttacks(Square sq, Bitboard occupied, const int (*dirs)[2]) {
+    Bitboard result = 0;
+    for (int d = 0; d < 4; ++d) {
+        int f = fileOf(sq) + dirs[d][0];
+        int r = rankOf(sq) + dirs[d][1];
+        while (f >= 0 && f < 8 && r >= 0 && r < 8) {
+            Bitboard b = squareBB(makeSquare(f, r));
+            result |= b;
+            if (occupied & b) break;
+            f += dirs[d][0];
+            r += dirs[d][1];
+        }
+    }
+    return result;
+}
+
+// xorshift64* generator; fixed seeds keep the magic search deterministic.
+class Prng {
+    uint64_t s;
+public:
+    explicit Prng(uint64_t seed) : s(seed) {}
+    uint64_t next() {
+        s ^= s >> 12;
+        s ^= s << 25;
+        s ^= s >> 27;
+        return s * 2685821657736338717ULL;
+    }
+    uint64_t sparse() { return next() & next() & next(); }
+};
+
+Bitboard RookTable[0x19000];
+Bitboard BishopTable[0x1480];
+
+void initMagics(Magic* magics, Bitboard* table, const int (*dirs)[2]) {
+#if !defined(USE_PEXT)
+    static const uint64_t seeds[8] = { 728, 10316, 55013, 32803, 12281, 15100, 16645, 255 };
+    static Bitboard occupancy[4096];
+    static int epoch[4096];
+    static int attempt = 0;
+#endif
+    static Bitboard reference[4096];
+    Bitboard* next = table;
+
+    for (Square sq = 0; sq < 64; ++sq) {
+        // Board edges never block a ray, so they are left out of the mask.
+        Bitboard edges = ((Rank1BB | Rank8BB) & ~(Rank1BB << (8 * rankOf(sq))))
+            | ((FileABB | FileHBB) & ~(FileABB << fileOf(sq)));
+        Magic& m = magics[sq];
+        m.mask = slidingAttacks(sq, 0, dirs) & ~edges;
+        m.shift = 64 - popCount(m.mask);
+        m.attacks = next;
+
+        // Carry-Rippler enumeration of every subset of the mask.
+        int size = 0;
+        Bitboard b = 0;
+        do {
+            reference[size] = slidingAttacks(sq, b, dirs);
+#if defined(USE_PEXT)
+            m.attacks[_pext_u64(b, m.mask)] = reference[size];
+#else
+            occupancy[size] = b;
+#endif
+            ++size;
+            b = (b - m.mask) & m.mask;
+        } while (b);
+        next += size;
+
+#if !defined(USE_PEXT)
+        Prng rng(seeds[rankOf(sq)]);
+        for (int i = 0; i < size;) {
+            for (m.magic = 0; popCount((m.magic * m.mask) >> 56) < 6;)
+                m.magic = rng.sparse();
+            // epoch[] marks which slots were written during this attempt, so
+            // the table does not have to be cleared between tries.
+            ++attempt;
+            for (i = 0; i < size; ++i) {
+                unsigned idx = m.index(occupancy[i]);
+                if (epoch[idx] < attempt) {
+                    epoch[idx] = attempt;
+                    m.attacks[idx] = reference[i];
+                }
+                else if (m.attacks[idx] != reference[i])
+                    break;
+            }
+        }
+#endif
+    }
+}
+
+} // namespace
+
+void initAttackTables() {
+    static bool initialized = false;
+    if (initialized) return;
+    initialized = true;
+    initMagics(RookMagics, RookTable, RookDirs);
+    initMagics(BishopMagics, BishopTable, BishopDirs);
+
+    for (Square a = 0; a < 64; ++a)
+        for (Square b = 0; b < 64; ++b) {
+            for (const int (*dirs)[2] : { RookDirs, BishopDirs }) {
+                if (!(slidingAttacks(a, 0, dirs) & squareBB(b))) continue;
+                LineBB[a][b] = (slidingAttacks(a, 0, dirs) & slidingAttacks(b, 0, dirs)) | squareBB(a) | squareBB(b);
+                BetweenBB[a][b] = slidingAttacks(a, squareBB(b), dirs) & slidingAttacks(b, squareBB(a), dirs);
+            }
+        }
+}
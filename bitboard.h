@@ -0,0 +1,106 @@
+#pragma once
+
+#include "types.h"
+
+#include <array>
+
+#if defined(__BMI2__) && !defined(USE_PEXT)
+#define USE_PEXT
+#endif
+
+#if defined(USE_PEXT)
+#include <immintrin.h>
+#endif
+
+constexpr Bitboard FileABB = 0x0101010101010101ULL;
+constexpr Bitboard FileHBB = FileABB << 7;
+constexpr Bitboard Rank1BB = 0xFFULL;
+constexpr Bitboard Rank8BB = Rank1BB << 56;
+
+// Sliding attacks are looked up through a per-square mask and either a magic
+// multiply or, on BMI2 builds, a PEXT of the masked occupancy.
+struct Magic {
+    Bitboard mask;
+    Bitboard magic;
+    Bitboard* attacks;
+    unsigned shift;
+
+    unsigned index(Bitboard occupied) const {
+#if defined(USE_PEXT)
+        return static_cast<unsigned>(_pext_u64(occupied, mask));
+#else
+        return static_cast<unsigned>(((occupied & mask) * magic) >> shift);
+#endif
+    }
+};
+
+extern Magic RookMagics[64];
+extern Magic BishopMagics[64];
+
+// BetweenBB holds the squares strictly between two aligned squares, LineBB
+// the whole rank, file or diagonal through them; both are empty otherwise.
+extern Bitboard BetweenBB[64][64];
+extern Bitboard LineBB[64][64];
+namespace detail {
+
+using StepTable = std::array<Bitboard, 64>;
+
+constexpr StepTable buildStepTable(const int (*steps)[2], int count) {
+    StepTable t{};
+    for (Square sq = 0; sq < 64; ++sq)
+        for (int i = 0; i < count; ++i) {
+            int f = fileOf(sq) + steps[i][0];
+            int r = rankOf(sq) + steps[i][1];
+            if (f >= 0 && f < 8 && r >= 0 && r < 8)
+                t[sq] |= squareBB(makeSquare(f, r));
+        }
+    return t;
+}
+
+constexpr int KnightSteps[8][2] = { {1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2} };
+constexpr int KingSteps[8][2] = { {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1} };
+constexpr int PawnSteps[2][2][2] = { { {-1, 1}, {1, 1} }, { {-1, -1}, {1, -1} } };
+
+} // namespace detail
+
+inline constexpr detail::StepTable KnightAttacks = detail::buildStepTable(detail::KnightSteps, 8);
+inline constexpr detail::StepTable KingAttacks = detail::buildStepTable(detail::KingSteps, 8);
+inline constexpr detail::StepTable PawnAttacks[2] = {
+    detail::buildStepTable(detail::PawnSteps[0], 2), detail::buildStepTable(detail::PawnSteps[1], 2)
+};
+
+// Builds the sliding-piece tables. Safe to call more than once.
+void initAttackTables();
+
+inline Bitboard knightAttacks(Square sq) { return KnightAttacks[sq]; }
+inline Bitboard kingAttacks(Square sq) { return KingAttacks[sq]; }
+inline Bitboard pawnAttacks(PieceColor c, Square sq) { return PawnAttacks[colorIndex(c)][sq]; }
+inline Bitboard rookAttacks(Square sq, Bitboard occupied) { return RookMagics[sq].attacks[RookMagics[sq].index(occupied)]; }
+inline Bitboard bishopAttacks(Square sq, Bitboard occupied) { return BishopMagics[sq].attacks[BishopMagics[sq].index(occupied)]; }
+inline Bitboard queenAttacks(Square sq, Bitboard occupied) { return rookAttacks(sq, occupied) | bishopAttacks(sq, occupied); }
+
+inline Bitboard betweenBB(Square a, Square b) { return BetweenBB[a][b]; }
+inline Bitboard lineBB(Square a, Square b) { return LineBB[a][b]; }
+inline bool aligned(Square a, Square b, Square c) { return (LineBB[a][b] & squareBB(c)) != 0; }
+
+template <PieceType T>
+inline Bitboard attacks(Square sq, Bitboard occupied) {
+    static_assert(T != PieceType::Pawn && T != PieceType::None, "pawn attacks depend on colour");
+    if constexpr (T == PieceType::King) return kingAttacks(sq);
+    else if constexpr (T == PieceType::Queen) return queenAttacks(sq, occupied);
+    else if constexpr (T == PieceType::Rook) return rookAttacks(sq, occupied);
+    else if constexpr (T == PieceType::Bishop) return bishopAttacks(sq, occupied);
+    else return knightAttacks(sq);
+}
+
+// Attacks of a non-pawn piece of the given type standing on sq.
+inline Bitboard pieceAttacks(PieceType type, Square sq, Bitboard occupied) {
+    switch (type) {
+    case PieceType::King: return kingAttacks(sq);
+    case PieceType::Queen: return queenAttacks(sq, occupied);
+    case PieceType::Rook: return rookAttacks(sq, occupied);
+    case PieceType::Bishop: return bishopAttacks(sq, occupied);
+    case PieceType::Knight: return knightAttacks(sq);
+    default: return 0;
+    }
+}
@@ -0,0 +1,80 @@
+#include "board.h"
+
+#include <iostream>
+
+using namespace std;
+
+// Pieces carry no per-square data, so every square of a given kind shares one
+// immutable facade object instead of owning a heap allocation.
+static const shared_ptr<Piece>& pieceFacade(PieceColor color, PieceType type) {
+    static const shared_ptr<Piece> facades[2][7] = {
+        { make_shared<King>(PieceColor::White), make_shared<Queen>(PieceColor::White),
+          make_shared<Rook>(PieceColor::White), make_shared<Bishop>(PieceColor::White),
+          make_shared<Knight>(PieceColor::White), make_shared<Pawn>(PieceColor::White), make_shared<Empty>() },
+        { make_shared<King>(PieceColor::Black), make_shared<Queen>(PieceColor::Black),
+          make_shared<Rook>(PieceColor::Black), make_shared<Bishop>(PieceColor::Black),
+          make_shared<Knight>(PieceColor::Black), make_shared<Pawn>(PieceColor::Black), make_shared<Empty>() }
+    };
+    return facades[colorIndex(color)][typeIndex(type)];
+}
+
+Board::Board() {
+    setup();
+}
+
+bool Board::fromFEN(const char* fen, Board& board) {
+    return board.state.setFEN(fen);
+}
+
+Board Board::clone() const {
+    return *this;
+}
+
+void Board::setup() {
+    state.setStartPosition();
+}
+
+void Board::draw() {
+    for (int i = 0; i < 8; i++) {
+        cout << 8 - i << " ";
+        for (int j = 0; j < 8; j++) {
+            cout << pieceSymbol(pieceAt({ i, j })) << " ";
+        }
+        cout << endl;
+    }
+    cout << "  a b c d e f g h" << endl;
+}
+
+bool Board::move(Position from, Position to, Move* played) {
+    if (!from.isValid() || !to.isValid()) return false;
+    Square src = toSquare(from);
+    Square dst = toSquare(to);
+    MoveList moves;
+    generateLegalMoves(state, moves);
+    for (const Move& m : moves) {
+        // Promotions are generated queen first, which is what the console plays.
+        if (m.from() == src && m.to() == dst) {
+            state.makeMove(m);
+            if (played) *played = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Board::hasLegalMoves() const {
+    MoveList moves;
+    generateLegalMoves(state, moves);
+    return !moves.empty();
+}
+
+shared_ptr<Piece> Board::getPiece(Position pos) {
+    PieceCode p = pieceAt(pos);
+    return pieceFacade(pieceColor(p), pieceType(p));
+}
+
+Position Board::findKing(PieceColor color) {
+    Square sq = state.kingSquare(color);
+    if (sq == NoSquare) return { -1, -1 };
+    return toPosition(sq);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "boardstate.h"
+#include "movegen.h"
+
+#include <memory>
+#include <string>
+
+class Piece {
+public:
+    PieceColor color;
+    PieceType type;
+
+    Piece(PieceColor color, PieceType type) : color(color), type(type) {}
+    virtual ~Piece() = default;
+
+    virtual bool isMoveValid(Position from, Position to, const BoardState& board) = 0;
+    virtual char getSymbol() const = 0;
+    virtual std::shared_ptr<Piece> clone() const = 0;
+};
+
+class Empty : public Piece {
+public:
+    Empty() : Piece(PieceColor::White, PieceType::None) {}
+    bool isMoveValid(Position, Position, const BoardState&) override { return false; }
+    char getSymbol() const override { return '.'; }
+    std::shared_ptr<Piece> clone() const override { return std::make_shared<Empty>(); }
+};
+
+// The concrete piece classes are a compatibility facade over PieceCode: their
+// rules and symbols come from the per-PieceType tables in movegen.h/types.h.
+template <PieceType T>
+class PieceFacade : public Piece {
+public:
+    explicit PieceFacade(PieceColor color) : Piece(color, T) {}
+    bool isMoveValid(Position from, Position to, const BoardState& board) override {
+        return (pieceTargets<T>(board, toSquare(from), color) & squareBB(toSquare(to))) != 0;
+    }
+    char getSymbol() const override { return pieceSymbol(makePiece(color, T)); }
+};
+
+class King : public PieceFacade<PieceType::King> {
+public:
+    using PieceFacade::PieceFacade;
+    std::shared_ptr<Piece> clone() const override { return std::make_shared<King>(*this); }
+};
+
+class Queen : public PieceFacade<PieceType::Queen> {
+public:
+    using PieceFacade::PieceFacade;
+    std::shared_ptr<Piece> clone() const override { return std::make_shared<Queen>(*this); }
+};
+
+class Rook : public PieceFacade<PieceType::Rook> {
+public:
+    using PieceFacade::PieceFacade;
+    std::shared_ptr<Piece> clone() const override { return std::make_shared<Rook>(*this); }
+};
+
+class Bishop : public PieceFacade<PieceType::Bishop> {
+public:
+    using PieceFacade::PieceFacade;
+    std::shared_ptr<Piece> clone() const override { return std::make_shared<Bishop>(*this); }
+};
+
+class Knight : public PieceFacade<PieceType::Knight> {
+public:
+    using PieceFacade::PieceFacade;
+    std::shared_ptr<Piece> clone() const override { return std::make_shared<Knight>(*this); }
+};
+
+class Pawn : public PieceFacade<PieceType::Pawn> {
+public:
+    using PieceFacade::PieceFacade;
+    std::shared_ptr<Piece> clone() const override { return std::make_shared<Pawn>(*this); }
+};
+
+class Board {
+private:
+    BoardState state;
+public:
+    Board();
+    explicit Board(const BoardState& position) : state(position) {}
+    // Builds a board straight from a FEN record, without running setup().
+    static bool fromFEN(const char* fen, Board& board);
+    std::string toFEN() const { return state.toFEN(); }
+    void setup();
+    void draw();
+    // Plays the legal move from -> to, reporting it through played if given.
+    bool move(Position from, Position to, Move* played = nullptr);
+    Undo makeMove(Move m) { return state.makeMove(m); }
+    void unmakeMove(const Undo& undo) { state.unmakeMove(undo); }
+    std::shared_ptr<Piece> getPiece(Position pos);
+    PieceCode pieceAt(Position pos) const { return state.pieceAt(toSquare(pos)); }
+    const BoardState& getState() const { return state; }
+    uint64_t hash() const { return state.key; }
+    Position findKing(PieceColor color);
+    bool isInCheck() const { return inCheck(state); }
+    bool hasLegalMoves() const;
+    Board clone() const;
+};
@@ -0,0 +1,289 @@
+#include "boardstate.h"
+
+#include "bitboard.h"
+
+#include <cstdio>
+#include <cstring>
+
+void BoardState::clear() {
+    std::memset(this, 0, sizeof(*this));
+    std::memset(mailbox, NoPiece, sizeof(mailbox));
+    sideToMove = PieceColor::White;
+    epSquare = NoSquare;
+    fullmoveNumber = 1;
+}
+
+void BoardState::setStartPosition() {
+    static const PieceType backRank[8] = {
+        PieceType::Rook, PieceType::Knight, PieceType::Bishop, PieceType::Queen,
+        PieceType::King, PieceType::Bishop, PieceType::Knight, PieceType::Rook
+    };
+    clear();
+    for (int f = 0; f < 8; ++f) {
+        putPiece(PieceColor::White, backRank[f], makeSquare(f, 0));
+        putPiece(PieceColor::White, PieceType::Pawn, makeSquare(f, 1));
+        putPiece(PieceColor::Black, PieceType::Pawn, makeSquare(f, 6));
+        putPiece(PieceColor::Black, backRank[f], makeSquare(f, 7));
+    }
+    castling = AllCastling;
+    key = computeKey();
+}
+
+bool BoardState::setFEN(const char* fen) {
+    clear();
+    const char* p = fen;
+    while (*p == ' ') ++p;
+
+    int rank = 7, file = 0;
+    for (; *p && *p != ' '; ++p) {
+        char ch = *p;
+        if (ch == '/') {
+            if (file != 8 || rank == 0) { clear(); return false; }
+            --rank;
+            file = 0;
+        }
+        else if (ch >= '1' && ch <= '8') {
+            file += ch - '0';
+        }
+        else {
+            PieceColor color = (ch >= 'a' && ch <= 'z') ? PieceColor::Black : PieceColor::White;
+            PieceType type;
+            switch (ch | 0x20) {
+            case 'k': type = PieceType::King; break;
+            case 'q': type = PieceType::Queen; break;
+            case 'r': type = PieceType::Rook; break;
+            case 'b': type = PieceType::Bishop; break;
+            case 'n': type = PieceType::Knight; break;
+            case 'p': type = PieceType::Pawn; break;
+            default: clear(); return false;
+            }
+            if (file > 7) { clear(); return false; }
+            putPiece(color, type, makeSquare(file++, rank));
+        }
+        if (file > 8) { clear(); return false; }
+    }
+    if (rank != 0 || file != 8 || *p != ' ') { clear(); return false; }
+    while (*p == ' ') ++p;
+
+    if (*p == 'w') sideToMove = PieceColor::White;
+    else if (*p == 'b') sideToMove = PieceColor::Black;
+    else { clear(); return false; }
+    ++p;
+    while (*p == ' ') ++p;
+
+    for (; *p && *p != ' '; ++p) {
+        switch (*p) {
+        case 'K': castling |= WhiteKingSide; break;
+        case 'Q': castling |= WhiteQueenSide; break;
+        case 'k': castling |= BlackKingSide; break;
+        case 'q': castling |= BlackQueenSide; break;
+        case '-': break;
+        default: clear(); return false;
+        }
+    }
+    while (*p == ' ') ++p;
+
+    if (*p == '-') {
+        ++p;
+    }
+    else if (*p >= 'a' && *p <= 'h' && (p[1] == '3' || p[1] == '6')) {
+        epSquare = static_cast<uint8_t>(makeSquare(*p - 'a', p[1] - '1'));
+        p += 2;
+    }
+    else if (*p) {
+        clear();
+        return false;
+    }
+    while (*p == ' ') ++p;
+
+    int halfmove = 0, fullmove = 0;
+    for (; *p >= '0' && *p <= '9'; ++p) halfmove = halfmove * 10 + (*p - '0');
+    while (*p == ' ') ++p;
+    for (; *p >= '0' && *p <= '9'; ++p) fullmove = fullmove * 10 + (*p - '0');
+    halfmoveClock = static_cast<uint8_t>(halfmove > 255 ? 255 : halfmove);
+    fullmoveNumber = static_cast<uint16_t>(fullmove > 0 ? fullmove : 1);
+
+    if (popCount(bb(PieceColor::White, PieceType::King)) != 1 || popCount(bb(PieceColor::Black, PieceType::King)) != 1) {
+        clear();
+        return false;
+    }
+    // Same convention as makeMove: an en-passant square nobody can capture on
+    // is dropped so that it does not split otherwise identical positions.
+    if (epSquare != NoSquare && !(pawnAttacks(~sideToMove, epSquare) & bb(sideToMove, PieceType::Pawn)))
+        epSquare = NoSquare;
+    key = computeKey();
+    return true;
+}
+
+int BoardState::writeFEN(char* out) const {
+    char* p = out;
+    for (int rank = 7; rank >= 0; --rank) {
+        int empty = 0;
+        for (int file = 0; file < 8; ++file) {
+            PieceCode pc = mailbox[makeSquare(file, rank)];
+            if (pc == NoPiece) {
+                ++empty;
+                continue;
+            }
+            if (empty) *p++ = static_cast<char>('0' + empty);
+            empty = 0;
+            *p++ = pieceSymbol(pc);
+        }
+        if (empty) *p++ = static_cast<char>('0' + empty);
+        if (rank) *p++ = '/';
+    }
+    *p++ = ' ';
+    *p++ = sideToMove == PieceColor::White ? 'w' : 'b';
+    *p++ = ' ';
+    if (!castling) *p++ = '-';
+    if (castling & WhiteKingSide) *p++ = 'K';
+    if (castling & WhiteQueenSide) *p++ = 'Q';
+    if (castling & BlackKingSide) *p++ = 'k';
+    if (castling & BlackQueenSide) *p++ = 'q';
+    *p++ = ' ';
+    if (epSquare == NoSquare) {
+        *p++ = '-';
+    }
+    else {
+        *p++ = static_cast<char>('a' + fileOf(epSquare));
+        *p++ = static_cast<char>('1' + rankOf(epSquare));
+    }
+    p += std::snprintf(p, 16, " %d %d", halfmoveClock, fullmoveNumber);
+    return static_cast<int>(p - out);
+}
+
+std::string BoardState::toFEN() const {
+    char buffer[MaxFENLength];
+    return std::string(buffer, writeFEN(buffer));
+}
+
+namespace {
+
+// Rook origin and destination for a castling king landing on kingTo.
+void castlingRookSquares(Square kingTo, Square& rookFrom, Square& rookTo) {
+    bool kingSide = fileOf(kingTo) == 6;
+    rookFrom = makeSquare(kingSide ? 7 : 0, rankOf(kingTo));
+    rookTo = makeSquare(kingSide ? 5 : 3, rankOf(kingTo));
+}
+
+} // namespace
+
+template <PieceColor Us>
+Undo BoardState::makeMove(Move m) {
+    constexpr PieceColor Them = ~Us;
+    constexpr int Up = Us == PieceColor::White ? 8 : -8;
+    Undo undo = { m, PieceType::None, castling, epSquare, halfmoveClock, key };
+    if (epSquare != NoSquare) key ^= Zobrist::enPassant(epSquare);
+    Square from = m.from();
+    Square to = m.to();
+    PieceType type = typeAt(from);
+
+    if (m.flags() & EnPassantMove) {
+        undo.captured = PieceType::Pawn;
+        removePiece(Them, PieceType::Pawn, to - Up);
+    }
+    else if ((undo.captured = typeAt(to)) != PieceType::None) {
+        removePiece(Them, undo.captured, to);
+    }
+
+    removePiece(Us, type, from);
+    putPiece(Us, (m.flags() & PromotionMove) ? m.promotion() : type, to);
+
+    if (m.flags() & CastlingMove) {
+        Square rookFrom, rookTo;
+        castlingRookSquares(to, rookFrom, rookTo);
+        removePiece(Us, PieceType::Rook, rookFrom);
+        putPiece(Us, PieceType::Rook, rookTo);
+    }
+
+    // The en-passant square is only recorded when an enemy pawn could use it.
+    epSquare = NoSquare;
+    if ((m.flags() & DoublePush) && (pawnAttacks(Us, from + Up) & bb(Them, PieceType::Pawn))) {
+        epSquare = static_cast<uint8_t>(from + Up);
+        key ^= Zobrist::enPassant(epSquare);
+    }
+    halfmoveClock = (type == PieceType::Pawn || undo.captured != PieceType::None) ? 0 : halfmoveClock + 1;
+    if (castling) {
+        uint8_t before = castling;
+        updateCastling(from, to);
+        key ^= Zobrist::castling(before ^ castling);
+    }
+    if constexpr (Us == PieceColor::Black) ++fullmoveNumber;
+    sideToMove = Them;
+    key ^= Zobrist::side();
+    return undo;
+}
+
+template Undo BoardState::makeMove<PieceColor::White>(Move m);
+template Undo BoardState::makeMove<PieceColor::Black>(Move m);
+
+Undo BoardState::makeNullMove() {
+    Undo undo = { NoMove, PieceType::None, castling, epSquare, halfmoveClock, key };
+    if (epSquare != NoSquare) key ^= Zobrist::enPassant(epSquare);
+    epSquare = NoSquare;
+    halfmoveClock = 0;
+    sideToMove = ~sideToMove;
+    key ^= Zobrist::side();
+    return undo;
+}
+
+void BoardState::unmakeNullMove(const Undo& undo) {
+    sideToMove = ~sideToMove;
+    epSquare = undo.epSquare;
+    halfmoveClock = undo.halfmoveClock;
+    key = undo.key;
+}
+
+template <PieceColor Us>
+void BoardState::unmakeMove(const Undo& undo) {
+    constexpr int Up = Us == PieceColor::White ? 8 : -8;
+    const Move& m = undo.move;
+    Square from = m.from();
+    Square to = m.to();
+    PieceType moved = typeAt(to);
+
+    sideToMove = Us;
+    if constexpr (Us == PieceColor::Black) --fullmoveNumber;
+    castling = undo.castling;
+    epSquare = undo.epSquare;
+    halfmoveClock = undo.halfmoveClock;
+
+    if (m.flags() & CastlingMove) {
+        Square rookFrom, rookTo;
+        castlingRookSquares(to, rookFrom, rookTo);
+        removePiece(Us, PieceType::Rook, rookTo);
+        putPiece(Us, PieceType::Rook, rookFrom);
+    }
+
+    removePiece(Us, moved, to);
+    putPiece(Us, (m.flags() & PromotionMove) ? PieceType::Pawn : moved, from);
+
+    if (m.flags() & EnPassantMove)
+        putPiece(~Us, PieceType::Pawn, to - Up);
+    else if (undo.captured != PieceType::None)
+        putPiece(~Us, undo.captured, to);
+    key = undo.key;
+}
+
+template void BoardState::unmakeMove<PieceColor::White>(const Undo& undo);
+template void BoardState::unmakeMove<PieceColor::Black>(const Undo& undo);
+
+uint64_t BoardState::computeKey() const {
+    uint64_t k = 0;
+    for (int c = 0; c < 2; ++c)
+        for (int t = 0; t < 6; ++t)
+            for (Bitboard b = pieces[c][t]; b;)
+                k ^= Zobrist::piece(static_cast<PieceColor>(c), static_cast<PieceType>(t), popLsb(b));
+    k ^= Zobrist::castling(castling);
+    if (epSquare != NoSquare) k ^= Zobrist::enPassant(epSquare);
+    if (sideToMove == PieceColor::Black) k ^= Zobrist::side();
+    return k;
+}
+
+uint64_t BoardState::computePawnKey() const {
+    uint64_t k = 0;
+    for (int c = 0; c < 2; ++c)
+        for (Bitboard b = pieces[c][typeIndex(PieceType::Pawn)]; b;)
+            k ^= Zobrist::piece(static_cast<PieceColor>(c), PieceType::Pawn, popLsb(b));
+    return k;
+}
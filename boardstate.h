@@ -0,0 +1,129 @@
+#pragma once
+
+#include "psqt.h"
+#include "types.h"
+#include "zobrist.h"
+
+#include <string>
+#include <type_traits>
+
+constexpr int MaxFENLength = 96;
+constexpr const char* StartFEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// Everything makeMove overwrites that cannot be recomputed from the move.
+struct Undo {
+    Move move;
+    PieceType captured;
+    uint8_t castling;
+    uint8_t epSquare;
+    uint8_t halfmoveClock;
+    uint64_t key;
+};
+
+// Flat, trivially copyable position: one bitboard per piece kind plus the
+// colour and total occupancy masks, a square-indexed mailbox for O(1)
+// "what stands here" queries, and the irreversible game state. The hash keys,
+// material/piece-square sum and game phase follow every putPiece/removePiece.
+struct BoardState {
+    Bitboard pieces[2][6];
+    Bitboard byColor[2];
+    Bitboard occupied;
+    PieceCode mailbox[64];
+    uint64_t key;
+    uint64_t pawnKey;  // pawns of both colours only, for the pawn hash
+    Score psq;
+    uint8_t phase;
+    PieceColor sideToMove;
+    uint8_t castling;
+    uint8_t epSquare;
+    uint8_t halfmoveClock;
+    uint16_t fullmoveNumber;
+
+    void clear();
+    void setStartPosition();
+    // Parses a FEN record in place; the halfmove and fullmove fields are
+    // optional. Returns false and leaves the state cleared on malformed input.
+    bool setFEN(const char* fen);
+    // Writes the FEN record plus a terminating NUL into out, which must hold
+    // at least MaxFENLength bytes; returns the length written.
+    int writeFEN(char* out) const;
+    std::string toFEN() const;
+
+    Bitboard bb(PieceColor c, PieceType t) const { return pieces[colorIndex(c)][typeIndex(t)]; }
+    Bitboard colorBB(PieceColor c) const { return byColor[colorIndex(c)]; }
+    Bitboard typeBB(PieceType t) const { return pieces[0][typeIndex(t)] | pieces[1][typeIndex(t)]; }
+
+    // Applies a pseudo-legal move in place; the returned record lets
+    // unmakeMove restore the previous position exactly. The colour-templated
+    // forms are for callers that already know the side to move.
+    template <PieceColor Us> Undo makeMove(Move m);
+    template <PieceColor Us> void unmakeMove(const Undo& undo);
+    Undo makeMove(Move m) {
+        return sideToMove == PieceColor::White ? makeMove<PieceColor::White>(m) : makeMove<PieceColor::Black>(m);
+    }
+    void unmakeMove(const Undo& undo) {
+        if (sideToMove == PieceColor::Black) unmakeMove<PieceColor::White>(undo);
+        else unmakeMove<PieceColor::Black>(undo);
+    }
+    // Passes the turn, for null-move pruning. The fifty-move counter restarts
+    // so repetition checks never look back across the null move.
+    Undo makeNullMove();
+    void unmakeNullMove(const Undo& undo);
+
+    // Hash recomputed from scratch; key is maintained incrementally and must
+    // always equal this.
+    uint64_t computeKey() const;
+    uint64_t computePawnKey() const;
+
+    PieceCode pieceAt(Square sq) const { return mailbox[sq]; }
+    PieceType typeAt(Square sq) const { return pieceType(mailbox[sq]); }
+    PieceColor colorAt(Square sq) const { return pieceColor(mailbox[sq]); }
+    bool isEmpty(Square sq) const { return !(occupied & squareBB(sq)); }
+
+    void putPiece(PieceColor c, PieceType t, Square sq) {
+        Bitboard b = squareBB(sq);
+        pieces[colorIndex(c)][typeIndex(t)] |= b;
+        byColor[colorIndex(c)] |= b;
+        occupied |= b;
+        mailbox[sq] = makePiece(c, t);
+        key ^= Zobrist::piece(c, t, sq);
+        if (t == PieceType::Pawn) pawnKey ^= Zobrist::piece(c, t, sq);
+        psq += PSQT::value(c, t, sq);
+        phase += PSQT::phaseWeight(t);
+    }
+    void removePiece(PieceColor c, PieceType t, Square sq) {
+        Bitboard b = ~squareBB(sq);
+        pieces[colorIndex(c)][typeIndex(t)] &= b;
+        byColor[colorIndex(c)] &= b;
+        occupied &= b;
+        mailbox[sq] = NoPiece;
+        key ^= Zobrist::piece(c, t, sq);
+        if (t == PieceType::Pawn) pawnKey ^= Zobrist::piece(c, t, sq);
+        psq -= PSQT::value(c, t, sq);
+        phase -= PSQT::phaseWeight(t);
+    }
+
+    // Drops the castling rights of any king or rook that a move from src to dst
+    // displaces or captures.
+    void updateCastling(Square src, Square dst) {
+        castling &= castlingKept(src) & castlingKept(dst);
+    }
+    static uint8_t castlingKept(Square sq) {
+        switch (sq) {
+        case 0: return static_cast<uint8_t>(~WhiteQueenSide);
+        case 4: return static_cast<uint8_t>(~(WhiteKingSide | WhiteQueenSide));
+        case 7: return static_cast<uint8_t>(~WhiteKingSide);
+        case 56: return static_cast<uint8_t>(~BlackQueenSide);
+        case 60: return static_cast<uint8_t>(~(BlackKingSide | BlackQueenSide));
+        case 63: return static_cast<uint8_t>(~BlackKingSide);
+        default: return AllCastling;
+        }
+    }
+
+    Square kingSquare(PieceColor c) const {
+        Bitboard k = bb(c, PieceType::King);
+        return k ? lsb(k) : NoSquare;
+    }
+};
+
+static_assert(std::is_trivially_copyable<BoardState>::value, "BoardState is copied with memcpy semantics");
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "boardstate.h"
+#include "mappedfile.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// Polyglot opening book. The .bin file is memory-mapped, never parsed: it
+// is a key-sorted array of 16-byte big-endian entries, so a probe is a
+// binary search over the mapped pages and many engines share one copy.
+class OpeningBook {
+public:
+    bool open(const char* path);
+    void close() { file.close(); }
+    bool isOpen() const { return file.isOpen(); }
+    size_t entryCount() const { return file.size() / EntrySize; }
+
+    // A legal book move for the position, or NoMove. Moves are drawn at
+    // random in proportion to their weights unless bestOnly is set.
+    Move probe(const BoardState& state, bool bestOnly = false);
+
+    // Polyglot position key: pieces, castling rights, a capturable en-passant
+    // file and the side to move.
+    static uint64_t key(const BoardState& state);
+
+    static constexpr size_t EntrySize = 16;
+
+private:
+    MappedFile file;
+    uint64_t rng = 0x2545F4914F6CDD1DULL;
+};
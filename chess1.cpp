@@ -3,309 +3,258 @@
 #include <memory>
 #include <cmath>
 #include <cstdlib>
-#include <ctime>
+#include <string>
+#include <chrono>
+#include <sstream>
 
-using namespace std;
-
-enum class PieceColor { White, Black };
-enum class PieceType { King, Queen, Rook, Bishop, Knight, Pawn, None };
+#include "analysis.h"
+#include "bench.h"
+#include "bitboard.h"
+#include "boardstate.h"
+#include "fen.h"
+#include "game.h"
+#include "movegen.h"
+#include "perft.h"
+#include "pgn.h"
+#include "search.h"
+#include "selfplay.h"
+#include "selftest.h"
+#include "tablebase.h"
+#include "thread.h"
+#include "trainingdata.h"
+#include "uci.h"
 
-struct Position {
-    int row;
-    int col;
+using namespace std;
 
-    bool isValid() const {
-        return row >= 0 && row < 8 && col >= 0 && col < 8;
+static bool searchPosition(const string& fen, int depth, size_t hashMB, bool largePages, int threads,
+                           const string& evalFile, const SearchFeatures& features) {
+    BoardState root;
+    if (!root.setFEN(fen.c_str())) {
+        cout << "invalid FEN: " << fen << endl;
+        return false;
     }
-};
-
-class Piece {
-public:
-    PieceColor color;
-    PieceType type;
-
-    Piece(PieceColor color, PieceType type) : color(color), type(type) {}
-    virtual ~Piece() = default;
+    unique_ptr<Evaluator> evaluator = loadEvaluator(evalFile);
+    TranspositionTable tt(hashMB, largePages);
+    SearchPool pool(*evaluator, tt, threads);
+    pool.setFeatures(features);
+    pool.onIteration = [&](const SearchInfo& info) {
+        cout << "depth " << info.depth << " score " << info.score << " nodes " << info.nodes
+             << " time " << info.timeMs << "ms pv";
+        for (const Move& m : info.pv) cout << " " << moveToString(m);
+        cout << endl;
+    };
+    SearchLimits limits;
+    limits.depth = depth;
+    SearchResult result = pool.think(root, limits);
 
-    virtual bool isMoveValid(Position from, Position to, const vector<vector<shared_ptr<Piece>>>& board) = 0;
-    virtual char getSymbol() const = 0;
-    virtual shared_ptr<Piece> clone() const = 0;
-};
+    vector<ThreadStats> stats = pool.stats();
+    for (size_t i = 0; i < stats.size(); ++i) {
+        const ThreadStats& s = stats[i];
+        cout << "thread " << i << " depth " << s.depth << " nodes " << s.nodes
+             << " nps " << (s.timeMs > 0 ? s.nodes * 1000 / s.timeMs : 0) << endl;
+        if (SearchStats::Enabled) cout << "  " << s.search.describe() << endl;
+    }
+    if (SearchStats::Enabled && stats.size() > 1) cout << "total " << result.stats.describe() << endl;
+    cout << "bestmove " << moveToString(result.bestMove) << " nodes " << result.nodes << " time " << result.timeMs
+         << "ms nps " << (result.timeMs > 0 ? result.nodes * 1000 / result.timeMs : 0)
+         << " hashfull " << tt.hashfull() << endl;
+    return true;
+}
 
-class Empty : public Piece {
-public:
-    Empty() : Piece(PieceColor::White, PieceType::None) {}
-    bool isMoveValid(Position, Position, const vector<vector<shared_ptr<Piece>>>&) override { return false; }
-    char getSymbol() const override { return '.'; }
-    shared_ptr<Piece> clone() const override { return make_shared<Empty>(); }
-};
+int main(int argc, char* argv[]) {
+	system("chcp 1251>null");
+    initAttackTables();
 
-class King : public Piece {
-public:
-    King(PieceColor color) : Piece(color, PieceType::King) {}
-    bool isMoveValid(Position from, Position to, const vector<vector<shared_ptr<Piece>>>& board) override {
-        int dx = abs(from.row - to.row);
-        int dy = abs(from.col - to.col);
-        auto dest = board[to.row][to.col];
-        if (dest->type != PieceType::None && dest->color == color) return false;
-        return dx <= 1 && dy <= 1;
+    // Global options come before the command:
+    //   --hash <MB>      transposition table size (default 16)
+    //   --large-pages    back the transposition table with large pages
+    //   --threads <N>    search threads (default 1)
+    //   --eval-file <f>  NNUE network to evaluate with instead of the handcrafted eval
+    //   --book <f>       Polyglot opening book for the engine's moves
+    //   --syzygy-path <p> Syzygy tablebase directories
+    //   --opponent-eval <f> network for the second engine of a match
+    //   --pgn <f>        save the console game, or every match game, as PGN
+    //   --data <f>       append match positions to a binary training file
+    //   --disable <a,b>  switch off search features by name (NullMove, LMR,
+    //                    Futility, ReverseFutility, Razoring, CheckExtensions,
+    //                    AspirationWindows) for search, bench and analyze
+    size_t hashMB = 16;
+    bool largePages = false;
+    int threads = 1;
+    string evalFile;
+    string bookFile;
+    string syzygyPath;
+    string opponentEval;
+    string pgnFile;
+    string dataFile;
+    SearchFeatures features;
+    int argi = 1;
+    for (; argi < argc && argv[argi][0] == '-'; ++argi) {
+        string opt = argv[argi];
+        if (opt == "--hash" && argi + 1 < argc) hashMB = strtoul(argv[++argi], nullptr, 10);
+        else if (opt == "--large-pages") largePages = true;
+        else if (opt == "--threads" && argi + 1 < argc) threads = atoi(argv[++argi]);
+        else if (opt == "--eval-file" && argi + 1 < argc) evalFile = argv[++argi];
+        else if (opt == "--book" && argi + 1 < argc) bookFile = argv[++argi];
+        else if (opt == "--syzygy-path" && argi + 1 < argc) syzygyPath = argv[++argi];
+        else if (opt == "--opponent-eval" && argi + 1 < argc) opponentEval = argv[++argi];
+        else if (opt == "--pgn" && argi + 1 < argc) pgnFile = argv[++argi];
+        else if (opt == "--data" && argi + 1 < argc) dataFile = argv[++argi];
+        else if (opt == "--disable" && argi + 1 < argc) {
+            stringstream names(argv[++argi]);
+            for (string name; getline(names, name, ',');)
+                if (!features.set(name, false)) cout << "unknown search feature " << name << endl;
+        }
     }
-    char getSymbol() const override { return color == PieceColor::White ? 'K' : 'k'; }
-    shared_ptr<Piece> clone() const override { return make_shared<King>(*this); }
-};
+    vector<string> args(argv + argi, argv + argc);
+    Tablebases::init(syzygyPath);
 
-class Queen : public Piece {
-public:
-    Queen(PieceColor color) : Piece(color, PieceType::Queen) {}
-    bool isMoveValid(Position from, Position to, const vector<vector<shared_ptr<Piece>>>& board) override {
-        int dx = abs(from.row - to.row);
-        int dy = abs(from.col - to.col);
-        auto dest = board[to.row][to.col];
-        if (dest->type != PieceType::None && dest->color == color) return false;
-        return dx == dy || from.row == to.row || from.col == to.col;
+    // chess1 perft [suite [depth]]   reference positions against known counts
+    // chess1 perft <depth> [fen]     per-depth node counts and root divide
+    if (!args.empty() && args[0] == "perft") {
+        if (args.size() == 1 || args[1] == "suite")
+            return runPerftSuite(args.size() > 2 ? stoi(args[2]) : 5) ? 0 : 1;
+        string fen = StartFEN;
+        if (args.size() > 2) {
+            fen = args[2];
+            for (size_t i = 3; i < args.size(); ++i) fen += " " + args[i];
+        }
+        return runPerft(fen.c_str(), stoi(args[1])) ? 0 : 1;
     }
-    char getSymbol() const override { return color == PieceColor::White ? 'Q' : 'q'; }
-    shared_ptr<Piece> clone() const override { return make_shared<Queen>(*this); }
-};
 
-class Rook : public Piece {
-public:
-    Rook(PieceColor color) : Piece(color, PieceType::Rook) {}
-    bool isMoveValid(Position from, Position to, const vector<vector<shared_ptr<Piece>>>& board) override {
-        if (from.row != to.row && from.col != to.col) return false;
-        auto dest = board[to.row][to.col];
-        if (dest->type != PieceType::None && dest->color == color) return false;
-        return true;
-    }
-    char getSymbol() const override { return color == PieceColor::White ? 'R' : 'r'; }
-    shared_ptr<Piece> clone() const override { return make_shared<Rook>(*this); }
-};
+    // chess1 selftest                book keys and tablebase results against
+    //     published reference values
+    if (!args.empty() && args[0] == "selftest") return runSelfTest() ? 0 : 1;
 
-class Bishop : public Piece {
-public:
-    Bishop(PieceColor color) : Piece(color, PieceType::Bishop) {}
-    bool isMoveValid(Position from, Position to, const vector<vector<shared_ptr<Piece>>>& board) override {
-        int dx = abs(from.row - to.row);
-        int dy = abs(from.col - to.col);
-        auto dest = board[to.row][to.col];
-        if (dest->type != PieceType::None && dest->color == color) return false;
-        return dx == dy;
+    // chess1 bench [depth]           fixed-depth single-threaded search of the
+    //     bench positions; the node total must match across builds
+    if (!args.empty() && args[0] == "bench") {
+        unique_ptr<Evaluator> evaluator = loadEvaluator(evalFile);
+        runBench(*evaluator, args.size() > 1 ? stoi(args[1]) : DefaultBenchDepth, hashMB, features);
+        return 0;
     }
-    char getSymbol() const override { return color == PieceColor::White ? 'B' : 'b'; }
-    shared_ptr<Piece> clone() const override { return make_shared<Bishop>(*this); }
-};
 
-class Knight : public Piece {
-public:
-    Knight(PieceColor color) : Piece(color, PieceType::Knight) {}
-    bool isMoveValid(Position from, Position to, const vector<vector<shared_ptr<Piece>>>& board) override {
-        int dx = abs(from.row - to.row);
-        int dy = abs(from.col - to.col);
-        auto dest = board[to.row][to.col];
-        if (dest->type != PieceType::None && dest->color == color) return false;
-        return (dx == 2 && dy == 1) || (dx == 1 && dy == 2);
+    // chess1 uci                      UCI protocol on stdin/stdout
+    if (!args.empty() && args[0] == "uci") {
+        UciEngine engine(hashMB, largePages, threads, evalFile, bookFile);
+        engine.run(cin);
+        return 0;
     }
-    char getSymbol() const override { return color == PieceColor::White ? 'N' : 'n'; }
-    shared_ptr<Piece> clone() const override { return make_shared<Knight>(*this); }
-};
 
-class Pawn : public Piece {
-public:
-    Pawn(PieceColor color) : Piece(color, PieceType::Pawn) {}
-    bool isMoveValid(Position from, Position to, const vector<vector<shared_ptr<Piece>>>& board) override {
-        int dir = (color == PieceColor::White) ? -1 : 1;
-        int startRow = (color == PieceColor::White) ? 6 : 1;
-        auto dest = board[to.row][to.col];
-        if (from.col == to.col && dest->type == PieceType::None) {
-            if (to.row == from.row + dir) return true;
-            if (from.row == startRow && to.row == from.row + 2 * dir && board[from.row + dir][from.col]->type == PieceType::None)
-                return true;
+    // chess1 search <depth> [fen]     fixed-depth search with per-thread nps
+    if (!args.empty() && args[0] == "search" && args.size() > 1) {
+        string fen = StartFEN;
+        if (args.size() > 2) {
+            fen = args[2];
+            for (size_t i = 3; i < args.size(); ++i) fen += " " + args[i];
         }
-        else if (abs(to.col - from.col) == 1 && to.row == from.row + dir && dest->type != PieceType::None && dest->color != color) {
-            return true;
-        }
-        return false;
+        return searchPosition(fen, stoi(args[1]), hashMB, largePages, threads, evalFile, features) ? 0 : 1;
     }
-    char getSymbol() const override { return color == PieceColor::White ? 'P' : 'p'; }
-    shared_ptr<Piece> clone() const override { return make_shared<Pawn>(*this); }
-};
-
-class Board {
-private:
-    vector<vector<shared_ptr<Piece>>> board;
-public:
-    Board();
-    void setup();
-    void draw();
-    bool move(Position from, Position to);
-    shared_ptr<Piece> getPiece(Position pos);
-    const vector<vector<shared_ptr<Piece>>>& getState() const { return board; }
-    Position findKing(PieceColor color);
-    Board clone() const;
-};
-
-Board::Board() {
-    board.resize(8, vector<shared_ptr<Piece>>(8));
-    setup();
-}
-
-Board Board::clone() const {
-    Board newBoard;
-    for (int i = 0; i < 8; ++i)
-        for (int j = 0; j < 8; ++j)
-            newBoard.board[i][j] = board[i][j]->clone();
-    return newBoard;
-}
 
-void Board::setup() {
-    for (int i = 0; i < 8; i++)
-        for (int j = 0; j < 8; j++)
-            board[i][j] = make_shared<Empty>();
-
-    board[0][0] = make_shared<Rook>(PieceColor::Black);
-    board[0][1] = make_shared<Knight>(PieceColor::Black);
-    board[0][2] = make_shared<Bishop>(PieceColor::Black);
-    board[0][3] = make_shared<Queen>(PieceColor::Black);
-    board[0][4] = make_shared<King>(PieceColor::Black);
-    board[0][5] = make_shared<Bishop>(PieceColor::Black);
-    board[0][6] = make_shared<Knight>(PieceColor::Black);
-    board[0][7] = make_shared<Rook>(PieceColor::Black);
-    for (int j = 0; j < 8; ++j)
-        board[1][j] = make_shared<Pawn>(PieceColor::Black);
-
-    for (int j = 0; j < 8; ++j)
-        board[6][j] = make_shared<Pawn>(PieceColor::White);
-    board[7][0] = make_shared<Rook>(PieceColor::White);
-    board[7][1] = make_shared<Knight>(PieceColor::White);
-    board[7][2] = make_shared<Bishop>(PieceColor::White);
-    board[7][3] = make_shared<Queen>(PieceColor::White);
-    board[7][4] = make_shared<King>(PieceColor::White);
-    board[7][5] = make_shared<Bishop>(PieceColor::White);
-    board[7][6] = make_shared<Knight>(PieceColor::White);
-    board[7][7] = make_shared<Rook>(PieceColor::White);
-}
-
-void Board::draw() {
-    for (int i = 0; i < 8; i++) {
-        cout << 8 - i << " ";
-        for (int j = 0; j < 8; j++) {
-            cout << board[i][j]->getSymbol() << " ";
+    // chess1 analyze <file.epd> <depth>
+    //     analyses every position on --threads threads, one position per
+    //     thread, and prints it back as EPD with bm/ce/acd/acn/pv
+    if (!args.empty() && args[0] == "analyze" && args.size() > 2) {
+        vector<BoardState> positions;
+        if (!loadFENFile(args[1].c_str(), positions)) {
+            cout << "cannot open " << args[1] << endl;
+            return 1;
         }
-        cout << endl;
-    }
-    cout << "  a b c d e f g h" << endl;
-}
-
-bool Board::move(Position from, Position to) {
-    auto piece = getPiece(from);
-    if (!piece->isMoveValid(from, to, board)) {
-        return false;
-    }
-    if (piece->type == PieceType::Pawn && (to.row == 0 || to.row == 7)) {
-        board[to.row][to.col] = make_shared<Queen>(piece->color);
-    }
-    else {
-        board[to.row][to.col] = piece;
-    }
-    board[from.row][from.col] = make_shared<Empty>();
-    return true;
-}
-
-shared_ptr<Piece> Board::getPiece(Position pos) {
-    return board[pos.row][pos.col];
-}
+        unique_ptr<Evaluator> evaluator = loadEvaluator(evalFile);
+        SearchLimits limits;
+        limits.depth = stoi(args[2]);
+        AnalysisOptions options;
+        options.threads = threads;
+        options.hashMB = hashMB;
+        options.largePages = largePages;
+        options.features = features;
+        auto started = chrono::steady_clock::now();
+        vector<SearchResult> results = analyzeBatch(positions, limits, *evaluator, options);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
 
-Position Board::findKing(PieceColor color) {
-    for (int i = 0; i < 8; ++i)
-        for (int j = 0; j < 8; ++j)
-            if (board[i][j]->type == PieceType::King && board[i][j]->color == color)
-                return { i, j };
-    return { -1, -1 };
-}
-
-class ChessGame {
-private:
-    Board board;
-    PieceColor currentTurn = PieceColor::White;
-    vector<string> moveHistory;
-public:
-    void start();
-    void nextTurn();
-    bool handleMove(Position from, Position to, const string& fromStr = "", const string& toStr = "");
-    bool isCheckmate(PieceColor color);
-};
-
-void ChessGame::start() {
-    srand(time(nullptr));
-    while (true) {
-        board.draw();
-        if (isCheckmate(currentTurn)) {
-            cout << (currentTurn == PieceColor::White ? " !\n" : " !\n");
-            break;
-        }
-        if (currentTurn == PieceColor::White) {
-            cout << "ճ \n  (, e2 e4): ";
-            string fromStr, toStr;
-            cin >> fromStr >> toStr;
-            Position from = { 8 - (fromStr[1] - '0'), fromStr[0] - 'a' };
-            Position to = { 8 - (toStr[1] - '0'), toStr[0] - 'a' };
-            if (handleMove(from, to, fromStr, toStr)) nextTurn();
-        }
-        else {
-            vector<pair<Position, Position>> moves;
-            for (int i = 0; i < 8; ++i) {
-                for (int j = 0; j < 8; ++j) {
-                    Position from = { i, j };
-                    auto piece = board.getPiece(from);
-                    if (piece->color != PieceColor::Black || piece->type == PieceType::None) continue;
-                    for (int x = 0; x < 8; ++x) {
-                        for (int y = 0; y < 8; ++y) {
-                            Position to = { x, y };
-                            if (piece->isMoveValid(from, to, board.getState())) {
-                                Board testBoard = board.clone();
-                                testBoard.move(from, to);
-                                if (testBoard.findKing(PieceColor::Black).row != -1) {
-                                    moves.push_back({ from, to });
-                                }
-                            }
-                        }
-                    }
+        uint64_t nodes = 0;
+        for (size_t i = 0; i < positions.size(); ++i) {
+            const SearchResult& r = results[i];
+            BoardState line = positions[i];
+            string fen = line.toFEN();
+            // EPD carries the first four FEN fields only.
+            for (int field = 0, at = 0; at < static_cast<int>(fen.size()); ++at)
+                if (fen[at] == ' ' && ++field == 4) {
+                    fen.resize(at);
+                    break;
                 }
+            cout << fen << " bm " << (r.bestMove != NoMove ? moveToSAN(line, r.bestMove) : "none") << "; ce " << r.score
+                 << "; acd " << r.depth << "; acn " << r.nodes << "; pv";
+            for (const Move& m : r.pv) {
+                cout << " " << moveToSAN(line, m);
+                line.makeMove(m);
             }
-            if (!moves.empty()) {
-                auto move = moves[rand() % moves.size()];
-                handleMove(move.first, move.second);
-                nextTurn();
-            }
+            cout << ";" << endl;
+            nodes += r.nodes;
         }
+        cout << "positions " << positions.size() << " nodes " << nodes << " time "
+             << static_cast<int64_t>(seconds * 1000) << "ms nps "
+             << (seconds > 0 ? static_cast<uint64_t>(nodes / seconds) : 0) << endl;
+        return 0;
     }
-}
 
-void ChessGame::nextTurn() {
-    currentTurn = (currentTurn == PieceColor::White) ? PieceColor::Black : PieceColor::White;
-}
+    // chess1 match <games> <base+inc> [openings.epd]
+    //     self-play match, seconds per game plus increment (e.g. 10+0.1);
+    //     --threads sets the number of concurrent games
+    if (!args.empty() && args[0] == "match" && args.size() > 2) {
+        MatchOptions options;
+        options.games = stoi(args[1]);
+        options.concurrency = threads;
+        size_t plus = args[2].find('+');
+        options.baseMs = static_cast<int64_t>(stod(args[2].substr(0, plus)) * 1000);
+        options.incrementMs = plus == string::npos ? 0 : static_cast<int64_t>(stod(args[2].substr(plus + 1)) * 1000);
+        if (args.size() > 3) options.openingsFile = args[3];
+        options.engines[0] = { evalFile, hashMB };
+        options.engines[1] = { opponentEval, hashMB };
+        options.pgnFile = pgnFile;
+        options.dataFile = dataFile;
+        return MatchRunner(options).run() ? 0 : 1;
+    }
 
-bool ChessGame::handleMove(Position from, Position to, const string& fromStr, const string& toStr) {
-    auto piece = board.getPiece(from);
-    if (!piece || piece->type == PieceType::None || piece->color != currentTurn)
-        return false;
-    if (board.move(from, to)) {
-        if (!fromStr.empty() && !toStr.empty())
-            moveHistory.push_back(fromStr + "-" + toStr);
-        return true;
+    // chess1 pgn <file>               replay every game of a PGN file
+    if (!args.empty() && args[0] == "pgn" && args.size() > 1) {
+        PgnStats stats;
+        if (!readPgnFile(args[1].c_str(), [](const PgnGame&) {}, &stats)) {
+            cout << "cannot open " << args[1] << endl;
+            return 1;
+        }
+        cout << "games " << stats.games << " moves " << stats.moves << " errors " << stats.errors
+             << " time " << static_cast<int64_t>(stats.seconds * 1000) << "ms" << endl;
+        if (stats.seconds > 0)
+            cout << static_cast<int64_t>(stats.games / stats.seconds) << " games/s "
+                 << stats.bytes / stats.seconds / (1 << 20) << " MB/s" << endl;
+        return 0;
     }
-    return false;
-}
 
-bool ChessGame::isCheckmate(PieceColor color) {
-    Position kingPos = board.findKing(color);
-    if (kingPos.row == -1) return true;
-    return false;
-}
+    // chess1 data <file>              decode a training file in shuffled order
+    if (!args.empty() && args[0] == "data" && args.size() > 1) {
+        TrainingReader reader;
+        if (!reader.open(args[1].c_str())) {
+            cout << "cannot open " << args[1] << endl;
+            return 1;
+        }
+        auto started = chrono::steady_clock::now();
+        reader.shuffle(chrono::steady_clock::now().time_since_epoch().count());
+        size_t results[3] = {}, invalid = 0;
+        BoardState position;
+        while (const TrainingEntry* e = reader.next()) {
+            if (!unpackEntry(*e, position)) ++invalid;
+            else ++results[e->result + 1];
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+        cout << "positions " << reader.size() << " white wins " << results[2] << " draws " << results[1]
+             << " black wins " << results[0] << " invalid " << invalid << endl;
+        if (seconds > 0) cout << static_cast<int64_t>(reader.size() / seconds) << " positions/s" << endl;
+        return 0;
+    }
 
-int main() {
-	system("chcp 1251>null");
-    ChessGame game;
+    ChessGame game(hashMB, largePages, threads, evalFile, bookFile);
     game.start();
+    if (!pgnFile.empty() && !game.savePgn(pgnFile)) cout << "cannot write " << pgnFile << endl;
     return 0;
 }
@@ -0,0 +1,174 @@
+#include "evaluate.h"
+
+#include "bitboard.h"
+
+#include <algorithm>
+
+int MaterialEvaluator::evaluate(const BoardState& state) {
+    int score = 0;
+    for (int t = typeIndex(PieceType::Queen); t <= typeIndex(PieceType::Pawn); ++t)
+        score += PieceValue[t] * (popCount(state.pieces[0][t]) - popCount(state.pieces[1][t]));
+    return state.sideToMove == PieceColor::White ? score : -score;
+}
+
+namespace {
+
+constexpr Score Doubled = makeScore(-11, -26);
+constexpr Score Isolated = makeScore(-8, -15);
+constexpr Score Backward = makeScore(-6, -12);
+// Indexed by the pawn's rank relative to its own side.
+constexpr Score Passed[8] = {
+    makeScore(0, 0), makeScore(2, 10), makeScore(5, 16), makeScore(12, 28),
+    makeScore(30, 55), makeScore(60, 105), makeScore(95, 165), makeScore(0, 0)
+};
+constexpr Score PawnShield = makeScore(9, 0);
+
+// Per reachable square beyond the given baseline, for knight, bishop, rook
+// and queen.
+constexpr Score MobilityWeight[6] = {
+    0, makeScore(2, 4), makeScore(3, 5), makeScore(5, 5), makeScore(5, 4), 0
+};
+constexpr int MobilityBase[6] = { 0, 14, 7, 7, 4, 0 };
+
+// Attack units a piece contributes when it hits the enemy king zone.
+constexpr int KingAttackWeight[6] = { 0, 5, 3, 2, 2, 0 };
+
+constexpr Bitboard fileBB(int file) { return FileABB << file; }
+
+struct PawnMasks {
+    Bitboard adjacentFiles[8];
+    Bitboard forwardFile[2][64];  // squares in front on the same file
+    Bitboard passedSpan[2][64];   // squares in front on the same and adjacent files
+};
+
+constexpr PawnMasks buildPawnMasks() {
+    PawnMasks m{};
+    for (int f = 0; f < 8; ++f)
+        m.adjacentFiles[f] = (f > 0 ? fileBB(f - 1) : 0) | (f < 7 ? fileBB(f + 1) : 0);
+    for (Square sq = 0; sq < 64; ++sq) {
+        Bitboard span = fileBB(fileOf(sq)) | m.adjacentFiles[fileOf(sq)];
+        for (int r = 0; r < 8; ++r) {
+            Bitboard rank = Rank1BB << (8 * r);
+            if (r > rankOf(sq)) {
+                m.forwardFile[0][sq] |= fileBB(fileOf(sq)) & rank;
+                m.passedSpan[0][sq] |= span & rank;
+            }
+            if (r < rankOf(sq)) {
+                m.forwardFile[1][sq] |= fileBB(fileOf(sq)) & rank;
+                m.passedSpan[1][sq] |= span & rank;
+            }
+        }
+    }
+    return m;
+}
+
+constexpr PawnMasks Masks = buildPawnMasks();
+
+Bitboard pawnAttackSpan(PieceColor c, Bitboard pawns) {
+    Bitboard west = pawns & ~FileABB, east = pawns & ~FileHBB;
+    return c == PieceColor::White ? (west << 7) | (east << 9) : (west >> 9) | (east >> 7);
+}
+
+Score pawnTerms(const BoardState& state, PieceColor us) {
+    PieceColor them = ~us;
+    int c = colorIndex(us);
+    Bitboard ours = state.bb(us, PieceType::Pawn);
+    Bitboard theirs = state.bb(them, PieceType::Pawn);
+    Bitboard ourAttacks = pawnAttackSpan(us, ours);
+    Bitboard theirAttacks = pawnAttackSpan(them, theirs);
+    Score s = 0;
+    for (Bitboard b = ours; b;) {
+        Square sq = popLsb(b);
+        int file = fileOf(sq);
+        int relRank = us == PieceColor::White ? rankOf(sq) : 7 - rankOf(sq);
+        Square stop = us == PieceColor::White ? sq + 8 : sq - 8;
+
+        if (Masks.forwardFile[c][sq] & ours) s += Doubled;
+        if (!(Masks.adjacentFiles[file] & ours)) s += Isolated;
+        // No friendly pawn can ever defend it, and the stop square is covered.
+        else if (!(Masks.passedSpan[1 - c][stop] & Masks.adjacentFiles[file] & ours)
+                 && (squareBB(stop) & theirAttacks) && !(squareBB(stop) & ourAttacks))
+            s += Backward;
+        if (!(Masks.passedSpan[c][sq] & theirs) && !(Masks.forwardFile[c][sq] & ours))
+            s += Passed[relRank];
+    }
+    return s;
+}
+
+template <PieceType T>
+void pieceTerms(const BoardState& state, PieceColor us, Bitboard safe, Bitboard kingZone,
+                Score& score, int& attackUnits, int& attackers) {
+    for (Bitboard b = state.bb(us, T); b;) {
+        Bitboard a = attacks<T>(popLsb(b), state.occupied);
+        score += MobilityWeight[typeIndex(T)] * (popCount(a & safe) - MobilityBase[typeIndex(T)]);
+        if (Bitboard hits = a & kingZone) {
+            ++attackers;
+            attackUnits += KingAttackWeight[typeIndex(T)] * popCount(hits);
+        }
+    }
+}
+
+// Mobility of our pieces and the pressure they put on the enemy king, minus
+// the holes in our own pawn shield.
+Score pieceTerms(const BoardState& state, PieceColor us) {
+    PieceColor them = ~us;
+    Square theirKing = state.kingSquare(them);
+    Square ourKing = state.kingSquare(us);
+    Bitboard kingZone = theirKing != NoSquare ? kingAttacks(theirKing) | squareBB(theirKing) : 0;
+    Bitboard safe = ~state.colorBB(us) & ~pawnAttackSpan(them, state.bb(them, PieceType::Pawn));
+
+    Score score = 0;
+    int attackUnits = 0, attackers = 0;
+    pieceTerms<PieceType::Knight>(state, us, safe, kingZone, score, attackUnits, attackers);
+    pieceTerms<PieceType::Bishop>(state, us, safe, kingZone, score, attackUnits, attackers);
+    pieceTerms<PieceType::Rook>(state, us, safe, kingZone, score, attackUnits, attackers);
+    pieceTerms<PieceType::Queen>(state, us, safe, kingZone, score, attackUnits, attackers);
+    // A lone attacker is rarely dangerous; pressure grows quadratically after that.
+    if (attackers >= 2)
+        score += makeScore(std::min(attackUnits * attackUnits, 500), 0);
+
+    if (ourKing != NoSquare) {
+        // Own pawns on the king's and adjacent files, one or two ranks ahead.
+        Bitboard zone = kingAttacks(ourKing) | squareBB(ourKing);
+        zone = us == PieceColor::White ? zone << 8 : zone >> 8;
+        Bitboard shield = zone & Masks.passedSpan[colorIndex(us)][ourKing] & state.bb(us, PieceType::Pawn);
+        score += PawnShield * popCount(shield);
+    }
+    return score;
+}
+
+} // namespace
+
+TaperedEvaluator::TaperedEvaluator(size_t pawnEntries) {
+    // Round down to a power of two so the key can be masked into an index.
+    size_t n = 2;
+    while (n * 2 <= pawnEntries) n *= 2;
+    // The first probe of an empty slot must miss, including for the pawnless
+    // key 0, so each slot starts out holding a key that indexes its neighbour.
+    pawnTable.resize(n);
+    for (size_t i = 0; i < n; ++i) pawnTable[i] = { i ^ 1, 0 };
+}
+
+Score TaperedEvaluator::probePawns(const BoardState& state) {
+    PawnEntry& e = pawnTable[state.pawnKey & (pawnTable.size() - 1)];
+    ++probes;
+    if (e.key == state.pawnKey) {
+        ++hits;
+        return e.score;
+    }
+    e.key = state.pawnKey;
+    e.score = pawnStructure(state);
+    return e.score;
+}
+
+Score TaperedEvaluator::pawnStructure(const BoardState& state) {
+    return pawnTerms(state, PieceColor::White) - pawnTerms(state, PieceColor::Black);
+}
+
+int TaperedEvaluator::evaluate(const BoardState& state) {
+    Score s = state.psq + probePawns(state)
+              + pieceTerms(state, PieceColor::White) - pieceTerms(state, PieceColor::Black);
+    int phase = std::min<int>(state.phase, PSQT::MaxPhase);
+    int score = (mgValue(s) * phase + egValue(s) * (PSQT::MaxPhase - phase)) / PSQT::MaxPhase;
+    return state.sideToMove == PieceColor::White ? score : -score;
+}
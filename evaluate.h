@@ -0,0 +1,59 @@
+#pragma once
+
+#include "boardstate.h"
+
+#include <memory>
+#include <vector>
+
+constexpr int PieceValue[7] = { 0, 900, 500, 330, 320, 100, 0 };
+
+// Positions are scored in centipawns from the side to move's point of view.
+// Every search thread owns its own evaluator, so implementations may keep
+// per-thread caches without locking.
+class Evaluator {
+public:
+    virtual ~Evaluator() = default;
+    virtual int evaluate(const BoardState& state) = 0;
+    virtual std::unique_ptr<Evaluator> clone() const = 0;
+    // Pawn-hash counters since construction, for evaluators that keep one.
+    virtual uint64_t pawnProbes() const { return 0; }
+    virtual uint64_t pawnHits() const { return 0; }
+};
+
+class MaterialEvaluator : public Evaluator {
+public:
+    int evaluate(const BoardState& state) override;
+    std::unique_ptr<Evaluator> clone() const override { return std::make_unique<MaterialEvaluator>(*this); }
+};
+
+// Tapered evaluation: the incrementally kept material and piece-square sum
+// plus mobility, pawn structure and king safety, blended between middlegame
+// and endgame weights by the remaining non-pawn material. Pawn structure is
+// cached per evaluator (and so per thread) under the position's pawn key.
+class TaperedEvaluator : public Evaluator {
+public:
+    explicit TaperedEvaluator(size_t pawnEntries = DefaultPawnEntries);
+
+    int evaluate(const BoardState& state) override;
+    std::unique_ptr<Evaluator> clone() const override { return std::make_unique<TaperedEvaluator>(*this); }
+
+    // Terms that depend on pawns alone, from White's point of view.
+    static Score pawnStructure(const BoardState& state);
+
+    uint64_t pawnProbes() const override { return probes; }
+    uint64_t pawnHits() const override { return hits; }
+
+    static constexpr size_t DefaultPawnEntries = 1 << 14;
+
+private:
+    struct PawnEntry {
+        uint64_t key;
+        Score score;
+    };
+
+    Score probePawns(const BoardState& state);
+
+    std::vector<PawnEntry> pawnTable;
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+};
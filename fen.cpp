@@ -0,0 +1,100 @@
+#include "fen.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <system_error>
+
+namespace {
+
+constexpr size_t ReadChunk = size_t(1) << 20;
+// Typical FEN line length, used only to size the output up front.
+constexpr size_t AverageLineBytes = 60;
+
+} // namespace
+
+size_t parseFENLines(char* begin, char* end, std::vector<BoardState>& out, size_t* rejected) {
+    size_t parsed = 0;
+    char* line = begin;
+    while (line < end) {
+        char* eol = static_cast<char*>(std::memchr(line, '\n', end - line));
+        if (!eol) eol = end;
+        char* stop = eol;
+        if (stop > line && stop[-1] == '\r') --stop;
+        char saved = stop < end ? *stop : '\0';
+        if (stop < end) *stop = '\0';
+
+        if (stop > line && *line != '#') {
+            out.emplace_back();
+            if (out.back().setFEN(line)) {
+                ++parsed;
+            }
+            else {
+                out.pop_back();
+                if (rejected) ++*rejected;
+            }
+        }
+        if (stop < end) *stop = saved;
+        line = eol + 1;
+    }
+    return parsed;
+}
+
+bool loadFENFile(const char* path, std::vector<BoardState>& out, size_t* rejected) {
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file) return false;
+
+    std::error_code ec;
+    auto bytes = std::filesystem::file_size(path, ec);
+    if (!ec) out.reserve(out.size() + static_cast<size_t>(bytes / AverageLineBytes) + 1);
+
+    // One chunk plus room for the partial line carried over from the last read.
+    std::unique_ptr<char[]> buffer(new char[ReadChunk * 2 + 1]);
+    size_t carried = 0;
+    // Set while the rest of an overlong line is still being read.
+    bool skipping = false;
+    while (true) {
+        size_t n = std::fread(buffer.get() + carried, 1, ReadChunk, file);
+        size_t filled = carried + n;
+        if (skipping && n) {
+            char* lineEnd = static_cast<char*>(std::memchr(buffer.get(), '\n', filled));
+            if (!lineEnd) continue;
+            skipping = false;
+            filled -= lineEnd + 1 - buffer.get();
+            std::memmove(buffer.get(), lineEnd + 1, filled);
+        }
+        if (n == 0) {
+            // Last line without a trailing newline.
+            if (filled) {
+                buffer[filled] = '\0';
+                parseFENLines(buffer.get(), buffer.get() + filled, out, rejected);
+            }
+            break;
+        }
+        char* lastNewline = nullptr;
+        for (char* p = buffer.get() + filled; p > buffer.get(); --p)
+            if (p[-1] == '\n') {
+                lastNewline = p - 1;
+                break;
+            }
+        if (!lastNewline) {
+            // A single line longer than a chunk is not a FEN; drop all of
+            // it, not just the part read so far.
+            if (filled > ReadChunk) {
+                carried = 0;
+                skipping = true;
+                if (rejected) ++*rejected;
+            }
+            else {
+                carried = filled;
+            }
+            continue;
+        }
+        parseFENLines(buffer.get(), lastNewline + 1, out, rejected);
+        carried = filled - (lastNewline + 1 - buffer.get());
+        std::memmove(buffer.get(), lastNewline + 1, carried);
+    }
+    std::fclose(file);
+    return true;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "boardstate.h"
+
+#include <cstddef>
+#include <vector>
+
+// Batch loading of FEN/EPD suites into one contiguous array. Trailing EPD
+// operations after the fourth field are ignored, and lines that do not
+// parse (including blank lines and '#' comments) are skipped and counted.
+
+// Parses the newline-separated records in [begin, end), appending to out.
+// The buffer is modified in place: line ends are overwritten with NULs so
+// each record is parsed without being copied. If the last record is not
+// newline-terminated, *end must be a NUL.
+size_t parseFENLines(char* begin, char* end, std::vector<BoardState>& out, size_t* rejected = nullptr);
+
+// Streams a file through a fixed read buffer. Returns false if the file
+// cannot be opened.
+bool loadFENFile(const char* path, std::vector<BoardState>& out, size_t* rejected = nullptr);
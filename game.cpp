@@ -0,0 +1,157 @@
+#include "game.h"
+
+#include "nnue.h"
+#include "pgn.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+using namespace std;
+
+// Falls back to the handcrafted evaluation when the network cannot be loaded.
+unique_ptr<Evaluator> loadEvaluator(const string& evalFile) {
+    bool usedNetwork = false;
+    unique_ptr<Evaluator> evaluator = makeEvaluator(evalFile, &usedNetwork);
+    if (usedNetwork) cout << "NNUE evaluation with " << Nnue::simdName() << " kernels" << endl;
+    else if (!evalFile.empty()) cout << "cannot load network " << evalFile << ", using handcrafted evaluation" << endl;
+    return evaluator;
+}
+
+ChessGame::ChessGame(size_t hashMB, bool largePages, int threads, const string& evalFile, const string& bookFile)
+    : evaluator(loadEvaluator(evalFile)), tt(hashMB, largePages), search(*evaluator, tt, threads) {
+    if (!bookFile.empty() && !book.open(bookFile.c_str()))
+        cout << "cannot open book " << bookFile << endl;
+    positions.push(board.hash());
+}
+
+SearchLimits ChessGame::engineLimits() const {
+    SearchLimits limits;
+    limits.timeMs = engineClockMs;
+    limits.incrementMs = EngineIncrementMs;
+    return limits;
+}
+
+void ChessGame::startPondering(const SearchResult& result) {
+    ponderMove = result.pv.size() > 1 ? result.pv[1] : NoMove;
+    if (ponderMove == NoMove) return;
+    BoardState predicted = board.getState();
+    predicted.makeMove(ponderMove);
+    KeyHistory keys = positions;
+    keys.push(predicted.key);
+    SearchLimits limits = engineLimits();
+    limits.ponder = true;
+    search.start(predicted, limits, &keys);
+}
+
+void ChessGame::stopPondering() {
+    if (ponderMove == NoMove) return;
+    search.stop();
+    search.wait();
+    ponderMove = NoMove;
+}
+
+void ChessGame::start() {
+    while (true) {
+        board.draw();
+        if (isCheckmate(currentTurn)) {
+            cout << (currentTurn == PieceColor::White ? " !\n" : " !\n");
+            break;
+        }
+        if (isStalemate(currentTurn)) {
+            cout << "! ͳ.\n";
+            break;
+        }
+        if (board.getState().halfmoveClock >= 100) {
+            cout << "ͳ   ' .\n";
+            break;
+        }
+        if (positions.repetitions(board.getState().halfmoveClock) >= 2) {
+            cout << "ͳ:   .\n";
+            break;
+        }
+        if (currentTurn == PieceColor::White) {
+            cout << "ճ \n  (, e2 e4): ";
+            string fromStr, toStr;
+            cin >> fromStr >> toStr;
+            Position from = { 8 - (fromStr[1] - '0'), fromStr[0] - 'a' };
+            Position to = { 8 - (toStr[1] - '0'), toStr[0] - 'a' };
+            if (handleMove(from, to)) nextTurn();
+        }
+        else {
+            // A ponder hit carries on with the search already under way;
+            // otherwise the guess was wrong and the search starts afresh.
+            bool ponderHit = ponderMove != NoMove && moveHistory.back() == ponderMove;
+            if (!ponderHit) stopPondering();
+            // Book moves are played instantly and keep the search clock for later.
+            Move bookMove = ponderHit ? NoMove : book.probe(board.getState());
+            if (bookMove != NoMove) {
+                board.makeMove(bookMove);
+                moveHistory.push_back(bookMove);
+                nextTurn();
+                continue;
+            }
+            auto started = chrono::steady_clock::now();
+            SearchResult result;
+            if (ponderHit) {
+                search.ponderhit();
+                result = search.wait();
+                ponderMove = NoMove;
+            }
+            else result = search.think(board.getState(), engineLimits(), &positions);
+            engineClockMs -= chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - started).count();
+            engineClockMs = max<int64_t>(engineClockMs, 0) + EngineIncrementMs;
+            board.makeMove(result.bestMove);
+            moveHistory.push_back(result.bestMove);
+            nextTurn();
+            startPondering(result);
+        }
+    }
+    stopPondering();
+}
+
+void ChessGame::nextTurn() {
+    currentTurn = (currentTurn == PieceColor::White) ? PieceColor::Black : PieceColor::White;
+    positions.push(board.hash());
+}
+
+bool ChessGame::handleMove(Position from, Position to) {
+    if (!from.isValid()) return false;
+    PieceCode piece = board.pieceAt(from);
+    if (pieceType(piece) == PieceType::None || pieceColor(piece) != currentTurn)
+        return false;
+    Move played;
+    if (board.move(from, to, &played)) {
+        moveHistory.push_back(played);
+        return true;
+    }
+    return false;
+}
+
+bool ChessGame::savePgn(const string& path) const {
+    FILE* out = fopen(path.c_str(), "w");
+    if (!out) return false;
+    PgnGame game;
+    game.tags = { { "Event", "chess1" }, { "White", "Human" }, { "Black", "chess1" } };
+    game.moves = moveHistory;
+    const BoardState& state = board.getState();
+    MoveList moves;
+    generateLegalMoves(state, moves);
+    if (moves.empty() && inCheck(state)) game.result = state.sideToMove == PieceColor::White ? "0-1" : "1-0";
+    else if (moves.empty() || state.halfmoveClock >= 100 || positions.repetitions(state.halfmoveClock) >= 2)
+        game.result = "1/2-1/2";
+    game.tags.emplace_back("Result", game.result);
+    writePgn(out, game);
+    fclose(out);
+    return true;
+}
+
+bool ChessGame::isCheckmate(PieceColor color) {
+    if (board.findKing(color).row == -1) return true;
+    return color == board.getState().sideToMove && board.isInCheck() && !board.hasLegalMoves();
+}
+
+bool ChessGame::isStalemate(PieceColor color) {
+    return color == board.getState().sideToMove && !board.isInCheck() && !board.hasLegalMoves();
+}
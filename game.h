@@ -0,0 +1,47 @@
+#pragma once
+
+#include "board.h"
+#include "book.h"
+#include "evaluate.h"
+#include "keyhistory.h"
+#include "thread.h"
+#include "tt.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Falls back to the handcrafted evaluation when the network cannot be loaded.
+std::unique_ptr<Evaluator> loadEvaluator(const std::string& evalFile);
+
+class ChessGame {
+private:
+    Board board;
+    PieceColor currentTurn = PieceColor::White;
+    std::vector<Move> moveHistory;
+    KeyHistory positions;   // one key per ply, for repetition draws
+    std::unique_ptr<Evaluator> evaluator;
+    TranspositionTable tt;
+    SearchPool search;
+    OpeningBook book;
+    // The engine plays on a clock of EngineBaseMs plus EngineIncrementMs per move.
+    static constexpr int64_t EngineBaseMs = 5 * 60 * 1000;
+    static constexpr int64_t EngineIncrementMs = 2000;
+    int64_t engineClockMs = EngineBaseMs;
+    // The reply the engine expects and is pondering on, or NoMove.
+    Move ponderMove = NoMove;
+
+    SearchLimits engineLimits() const;
+    // Searches the position after the expected reply while the player thinks.
+    void startPondering(const SearchResult& result);
+    void stopPondering();
+public:
+    ChessGame(size_t hashMB, bool largePages, int threads, const std::string& evalFile, const std::string& bookFile);
+    void start();
+    void nextTurn();
+    // Writes the game so far as PGN; false if the file cannot be created.
+    bool savePgn(const std::string& path) const;
+    bool handleMove(Position from, Position to);
+    bool isCheckmate(PieceColor color);
+    bool isStalemate(PieceColor color);
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+// Zobrist keys of the positions on the path to the current one, newest last,
+// kept in a fixed ring. Only positions since the last capture or pawn move
+// can repeat, and the fifty-move rule bounds those to ~100 plies, so a
+// repetition check touches at most halfmoveClock / 2 keys and older entries
+// may safely be overwritten.
+class KeyHistory {
+public:
+    static constexpr int Capacity = 1024;
+
+    void clear() { count = 0; }
+    void push(uint64_t key) { keys[count++ & (Capacity - 1)] = key; }
+    void pop() { --count; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    uint64_t top() const { return keys[(count - 1) & (Capacity - 1)]; }
+
+    // Earlier occurrences of the newest position, looking back no further
+    // than halfmoveClock plies. Only every other ply can match, since the
+    // side to move must be the same.
+    int repetitions(int halfmoveClock) const {
+        if (count == 0) return 0;
+        uint64_t key = top();
+        int horizon = halfmoveClock < count - 1 ? halfmoveClock : count - 1;
+        if (horizon > Capacity - 1) horizon = Capacity - 1;
+        int found = 0;
+        for (int back = 4; back <= horizon; back += 2)
+            if (keys[(count - 1 - back) & (Capacity - 1)] == key) ++found;
+        return found;
+    }
+
+private:
+    uint64_t keys[Capacity];
+    int count = 0;
+};
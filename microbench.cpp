@@ -0,0 +1,245 @@
+// Microbenchmarks for the board primitives, built as the chess1bench target.
+//
+//   chess1bench [filter] [--min-time <ms>]
+//
+// Every benchmark runs over the same fixed positions until at least
+// min-time has passed and reports nanoseconds per operation. The facade
+// paths (Board::clone, Piece::isMoveValid, Board::findKing) stay in the
+// suite as the baseline the bitboard primitives are measured against.
+
+#include "bitboard.h"
+#include "board.h"
+#include "book.h"
+#include "boardstate.h"
+#include "evaluate.h"
+#include "movegen.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* const SuiteFENs[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+    "r2q1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP3PPP/R1BQ1RK1 w - - 0 9",
+    "2r3k1/pp3ppp/4p3/3pP3/3P4/P3KP2/1P4PP/2R5 b - - 3 27",
+    "8/8/4k3/3p4/3P4/4K3/8/8 w - - 0 1",
+    "6k1/5ppp/8/8/8/8/5PPP/3Q2K1 w - - 0 1",
+    "4r1k1/1q3ppp/p7/1p1Pn3/4Q3/1B6/PP3PPP/4R1K1 b - - 0 25",
+};
+
+// Results are folded into this so the optimiser cannot drop the work.
+volatile uint64_t sink;
+
+struct Benchmark {
+    const char* name;
+    // Runs one pass over the suite and returns the number of operations.
+    std::function<uint64_t()> pass;
+};
+
+double runBenchmark(const Benchmark& b, double minSeconds) {
+    b.pass();   // warm caches and lazily built tables
+    uint64_t ops = 0;
+    Clock::time_point start = Clock::now();
+    double elapsed;
+    do {
+        ops += b.pass();
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < minSeconds);
+    return ops ? elapsed * 1e9 / ops : 0;
+}
+
+template <PieceType T>
+uint64_t targetsOfType(const std::vector<BoardState>& suite) {
+    uint64_t n = 0, acc = 0;
+    for (const BoardState& s : suite)
+        for (int c = 0; c < 2; ++c)
+            for (Bitboard b = s.bb(static_cast<PieceColor>(c), T); b; ++n)
+                acc += pieceTargets<T>(s, popLsb(b), static_cast<PieceColor>(c));
+    sink = sink + acc;
+    return n;
+}
+
+std::vector<Benchmark> makeBenchmarks(const std::vector<BoardState>& suite, std::vector<Board>& boards,
+                                      const std::vector<MoveList>& legal) {
+    static TaperedEvaluator tapered;
+    static MaterialEvaluator material;
+    return {
+        { "board/clone", [&] {
+            uint64_t acc = 0;
+            for (const Board& b : boards) acc += b.clone().hash();
+            sink = sink + acc;
+            return static_cast<uint64_t>(boards.size());
+        } },
+        { "board/move", [&] {
+            // The console path: validate (from, to) against the legal list, then play it.
+            uint64_t n = 0, acc = 0;
+            for (size_t i = 0; i < boards.size(); ++i)
+                for (const Move& m : legal[i]) {
+                    Board b = boards[i].clone();
+                    acc += b.move(toPosition(m.from()), toPosition(m.to()));
+                    ++n;
+                }
+            sink = sink + acc;
+            return n;
+        } },
+        { "board/isMoveValid", [&] {
+            // Baseline facade query for every (occupied from, any to) pair.
+            uint64_t n = 0, acc = 0;
+            for (Board& b : boards)
+                for (Bitboard occ = b.getState().occupied; occ;) {
+                    Position from = toPosition(popLsb(occ));
+                    std::shared_ptr<Piece> piece = b.getPiece(from);
+                    for (Square to = 0; to < 64; ++to, ++n)
+                        acc += piece->isMoveValid(from, toPosition(to), b.getState());
+                }
+            sink = sink + acc;
+            return n;
+        } },
+        { "board/findKing", [&] {
+            uint64_t acc = 0;
+            for (Board& b : boards)
+                acc += b.findKing(PieceColor::White).row + b.findKing(PieceColor::Black).col;
+            sink = sink + acc;
+            return static_cast<uint64_t>(boards.size() * 2);
+        } },
+        { "state/kingSquare", [&] {
+            uint64_t acc = 0;
+            for (const BoardState& s : suite) acc += s.kingSquare(PieceColor::White) + s.kingSquare(PieceColor::Black);
+            sink = sink + acc;
+            return static_cast<uint64_t>(suite.size() * 2);
+        } },
+        { "state/makeUnmake", [&] {
+            uint64_t n = 0, acc = 0;
+            for (size_t i = 0; i < suite.size(); ++i) {
+                BoardState s = suite[i];
+                for (const Move& m : legal[i]) {
+                    Undo u = s.makeMove(m);
+                    acc += s.key;
+                    s.unmakeMove(u);
+                    ++n;
+                }
+            }
+            sink = sink + acc;
+            return n;
+        } },
+        { "movegen/legal", [&] {
+            uint64_t acc = 0;
+            for (const BoardState& s : suite) {
+                MoveList moves;
+                generateLegalMoves(s, moves);
+                acc += moves.size();
+            }
+            sink = sink + acc;
+            return static_cast<uint64_t>(suite.size());
+        } },
+        { "movegen/captures", [&] {
+            uint64_t acc = 0;
+            for (const BoardState& s : suite) {
+                MoveList moves;
+                generateMoves<GenType::Captures>(s, moves);
+                acc += moves.size();
+            }
+            sink = sink + acc;
+            return static_cast<uint64_t>(suite.size());
+        } },
+        { "movegen/king", [&] { return targetsOfType<PieceType::King>(suite); } },
+        { "movegen/queen", [&] { return targetsOfType<PieceType::Queen>(suite); } },
+        { "movegen/rook", [&] { return targetsOfType<PieceType::Rook>(suite); } },
+        { "movegen/bishop", [&] { return targetsOfType<PieceType::Bishop>(suite); } },
+        { "movegen/knight", [&] { return targetsOfType<PieceType::Knight>(suite); } },
+        { "movegen/pawn", [&] { return targetsOfType<PieceType::Pawn>(suite); } },
+        { "attacks/isSquareAttacked", [&] {
+            uint64_t acc = 0;
+            for (const BoardState& s : suite)
+                for (Square sq = 0; sq < 64; ++sq) acc += isSquareAttacked(s, sq, ~s.sideToMove);
+            sink = sink + acc;
+            return static_cast<uint64_t>(suite.size() * 64);
+        } },
+        { "attacks/inCheck", [&] {
+            uint64_t acc = 0;
+            for (const BoardState& s : suite) acc += inCheck(s);
+            sink = sink + acc;
+            return static_cast<uint64_t>(suite.size());
+        } },
+        { "eval/material", [&] {
+            uint64_t acc = 0;
+            for (const BoardState& s : suite) acc += material.evaluate(s);
+            sink = sink + acc;
+            return static_cast<uint64_t>(suite.size());
+        } },
+        { "eval/tapered", [&] {
+            uint64_t acc = 0;
+            for (const BoardState& s : suite) acc += tapered.evaluate(s);
+            sink = sink + acc;
+            return static_cast<uint64_t>(suite.size());
+        } },
+        { "eval/pawnStructure", [&] {
+            uint64_t acc = 0;
+            for (const BoardState& s : suite) acc += TaperedEvaluator::pawnStructure(s);
+            sink = sink + acc;
+            return static_cast<uint64_t>(suite.size());
+        } },
+        { "hash/computeKey", [&] {
+            uint64_t acc = 0;
+            for (const BoardState& s : suite) acc += s.computeKey();
+            sink = sink + acc;
+            return static_cast<uint64_t>(suite.size());
+        } },
+        { "hash/polyglotKey", [&] {
+            uint64_t acc = 0;
+            for (const BoardState& s : suite) acc += OpeningBook::key(s);
+            sink = sink + acc;
+            return static_cast<uint64_t>(suite.size());
+        } },
+    };
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    initAttackTables();
+
+    const char* filter = nullptr;
+    double minSeconds = 0.5;
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--min-time") && i + 1 < argc) minSeconds = std::atof(argv[++i]) / 1000;
+        else filter = argv[i];
+    }
+
+    std::vector<BoardState> suite;
+    std::vector<Board> boards;
+    std::vector<MoveList> legal;
+    for (const char* fen : SuiteFENs) {
+        BoardState s;
+        if (!s.setFEN(fen)) {
+            std::printf("invalid FEN: %s\n", fen);
+            return 1;
+        }
+        suite.push_back(s);
+        boards.emplace_back(s);
+        legal.emplace_back();
+        generateLegalMoves(s, legal.back());
+    }
+
+    std::printf("%-28s %12s\n", "benchmark", "ns/op");
+    for (const Benchmark& b : makeBenchmarks(suite, boards, legal)) {
+        if (filter && !std::strstr(b.name, filter)) continue;
+        std::printf("%-28s %12.2f\n", b.name, runBenchmark(b, minSeconds));
+        std::fflush(stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,218 @@
+#include "movegen.h"
+
+namespace {
+
+template <int D>
+constexpr Bitboard shift(Bitboard b) {
+    return D > 0 ? b << D : b >> -D;
+}
+
+// Promotion pieces in the order they are listed. Captures and queen
+// promotions are noisy; the under-promotions of a plain push are quiet.
+template <GenType Type>
+void addPromotions(MoveList& list, Square from, Square to, uint8_t flags) {
+    bool capture = flags & CaptureMove;
+    if (Type != GenType::Quiets || capture)
+        list.add(from, to, flags | PromotionMove, PieceType::Queen);
+    if (Type != GenType::Captures || capture)
+        for (PieceType promo : { PieceType::Rook, PieceType::Bishop, PieceType::Knight })
+            list.add(from, to, flags | PromotionMove, promo);
+}
+
+// Own pieces that shield our king from an enemy slider.
+template <PieceColor Us>
+Bitboard pinnedPieces(const BoardState& state, Square ksq) {
+    constexpr PieceColor Them = ~Us;
+    Bitboard snipers = (rookAttacks(ksq, 0) & (state.bb(Them, PieceType::Rook) | state.bb(Them, PieceType::Queen)))
+        | (bishopAttacks(ksq, 0) & (state.bb(Them, PieceType::Bishop) | state.bb(Them, PieceType::Queen)));
+    Bitboard pinned = 0;
+    while (snipers) {
+        Bitboard blockers = betweenBB(ksq, popLsb(snipers)) & state.occupied;
+        if (blockers && !(blockers & (blockers - 1)))
+            pinned |= blockers & state.colorBB(Us);
+    }
+    return pinned;
+}
+
+// Pawns move set-wise: every push or capture in one direction is one shift
+// of the pawn bitboard. target holds the squares that resolve a check (all
+// of them when not in check); pinned pawns must stay on their pin line.
+template <PieceColor Us, GenType Type>
+void generatePawnMoves(const BoardState& state, MoveList& list, Bitboard target, Bitboard pinned, Square ksq) {
+    constexpr PieceColor Them = ~Us;
+    constexpr int Up = Us == PieceColor::White ? 8 : -8;
+    // Capture directions towards the h- and a-files.
+    constexpr int UpRight = Up + 1;
+    constexpr int UpLeft = Up - 1;
+    constexpr Bitboard DoublePushRank = Us == PieceColor::White ? Rank1BB << 16 : Rank1BB << 40;
+    constexpr Bitboard PromotionRank = Us == PieceColor::White ? Rank8BB : Rank1BB;
+
+    Bitboard pawns = state.bb(Us, PieceType::Pawn);
+    Bitboard empty = ~state.occupied;
+    Bitboard enemies = state.colorBB(Them);
+    auto legal = [&](Square from, Square to) { return !(pinned & squareBB(from)) || aligned(ksq, from, to); };
+
+    Bitboard single = shift<Up>(pawns) & empty;
+    if constexpr (Type != GenType::Captures) {
+        for (Bitboard b = single & target & ~PromotionRank; b;) {
+            Square to = popLsb(b);
+            if (legal(to - Up, to)) list.add(to - Up, to);
+        }
+        for (Bitboard b = shift<Up>(single & DoublePushRank) & empty & target; b;) {
+            Square to = popLsb(b);
+            if (legal(to - 2 * Up, to)) list.add(to - 2 * Up, to, DoublePush);
+        }
+    }
+    for (Bitboard b = single & target & PromotionRank; b;) {
+        Square to = popLsb(b);
+        if (legal(to - Up, to)) addPromotions<Type>(list, to - Up, to, QuietMove);
+    }
+    if constexpr (Type == GenType::Quiets) return;
+
+    Bitboard victims = enemies & target;
+    for (Bitboard b = shift<UpRight>(pawns & ~FileHBB) & victims; b;) {
+        Square to = popLsb(b);
+        if (!legal(to - UpRight, to)) continue;
+        if (PromotionRank & squareBB(to)) addPromotions<Type>(list, to - UpRight, to, CaptureMove);
+        else list.add(to - UpRight, to, CaptureMove);
+    }
+    for (Bitboard b = shift<UpLeft>(pawns & ~FileABB) & victims; b;) {
+        Square to = popLsb(b);
+        if (!legal(to - UpLeft, to)) continue;
+        if (PromotionRank & squareBB(to)) addPromotions<Type>(list, to - UpLeft, to, CaptureMove);
+        else list.add(to - UpLeft, to, CaptureMove);
+    }
+
+    // En passant can expose the king along the fifth rank with two pawns
+    // leaving it at once, so it is verified against the resulting occupancy.
+    if (state.epSquare != NoSquare) {
+        Square ep = state.epSquare;
+        Square victim = ep - Up;
+        for (Bitboard capturers = pawnAttacks(Them, ep) & pawns; capturers;) {
+            Square from = popLsb(capturers);
+            Bitboard occ = (state.occupied ^ squareBB(from) ^ squareBB(victim)) | squareBB(ep);
+            Bitboard attackers = attackersTo(state, ksq, occ) & state.colorBB(Them) & ~squareBB(victim);
+            if (!attackers)
+                list.add(from, ep, CaptureMove | EnPassantMove);
+        }
+    }
+}
+
+template <PieceColor Us>
+void generateCastling(const BoardState& state, MoveList& list, Square ksq) {
+    constexpr PieceColor Them = ~Us;
+    constexpr int Rank = Us == PieceColor::White ? 0 : 7;
+    constexpr uint8_t KingSide = Us == PieceColor::White ? WhiteKingSide : BlackKingSide;
+    constexpr uint8_t QueenSide = Us == PieceColor::White ? WhiteQueenSide : BlackQueenSide;
+    if (ksq != makeSquare(4, Rank)) return;
+
+    struct Side { uint8_t right; int rookFile; int kingTo; };
+    for (const Side& s : { Side{ KingSide, 7, 6 }, Side{ QueenSide, 0, 2 } }) {
+        if (!(state.castling & s.right)) continue;
+        Square rookSq = makeSquare(s.rookFile, Rank);
+        Square kingTo = makeSquare(s.kingTo, Rank);
+        if (!(state.bb(Us, PieceType::Rook) & squareBB(rookSq))) continue;
+        if (betweenBB(ksq, rookSq) & state.occupied) continue;
+        bool safe = true;
+        for (Bitboard path = betweenBB(ksq, kingTo) | squareBB(kingTo); path && safe;)
+            safe = !isSquareAttacked(state, popLsb(path), Them);
+        if (safe)
+            list.add(ksq, kingTo, CastlingMove);
+    }
+}
+
+template <PieceColor Us, PieceType T>
+void generatePieceMoves(const BoardState& state, MoveList& list, Bitboard target, Bitboard pinned, Square ksq) {
+    Bitboard enemies = state.colorBB(~Us);
+    for (Bitboard pieces = state.bb(Us, T); pieces;) {
+        Square from = popLsb(pieces);
+        Bitboard allowed = target;
+        if (pinned & squareBB(from)) {
+            // A pinned knight can never stay on the pin line.
+            if constexpr (T == PieceType::Knight) continue;
+            allowed &= lineBB(ksq, from);
+        }
+        for (Bitboard targets = attacks<T>(from, state.occupied) & allowed; targets;) {
+            Square to = popLsb(targets);
+            list.add(from, to, (enemies & squareBB(to)) ? CaptureMove : QuietMove);
+        }
+    }
+}
+
+template <PieceColor Us, GenType Type>
+void generateAll(const BoardState& state, MoveList& list) {
+    constexpr PieceColor Them = ~Us;
+    Bitboard own = state.colorBB(Us);
+    Bitboard enemies = state.colorBB(Them);
+    Square ksq = state.kingSquare(Us);
+    if (ksq == NoSquare) return;
+
+    // Destinations allowed by the generation type, before check is resolved.
+    Bitboard kind = Type == GenType::Captures ? enemies : Type == GenType::Quiets ? ~state.occupied : ~own;
+    Bitboard checkers = attackersTo(state, ksq, state.occupied) & enemies;
+
+    // The king is removed from the occupancy so that it cannot hide behind
+    // itself when stepping away from a slider.
+    Bitboard occWithoutKing = state.occupied ^ squareBB(ksq);
+    for (Bitboard targets = kingAttacks(ksq) & kind; targets;) {
+        Square to = popLsb(targets);
+        if (!(attackersTo(state, to, occWithoutKing) & enemies))
+            list.add(ksq, to, (enemies & squareBB(to)) ? CaptureMove : QuietMove);
+    }
+    if (checkers & (checkers - 1)) return;
+
+    Bitboard target = ~own;
+    if (checkers)
+        target = betweenBB(ksq, lsb(checkers)) | checkers;
+    else if constexpr (Type == GenType::Quiets || Type == GenType::Legal)
+        generateCastling<Us>(state, list, ksq);
+
+    Bitboard pinned = pinnedPieces<Us>(state, ksq);
+    generatePawnMoves<Us, Type>(state, list, target, pinned, ksq);
+    target &= kind;
+    generatePieceMoves<Us, PieceType::Knight>(state, list, target, pinned, ksq);
+    generatePieceMoves<Us, PieceType::Bishop>(state, list, target, pinned, ksq);
+    generatePieceMoves<Us, PieceType::Rook>(state, list, target, pinned, ksq);
+    generatePieceMoves<Us, PieceType::Queen>(state, list, target, pinned, ksq);
+}
+
+} // namespace
+
+Bitboard attackersTo(const BoardState& state, Square sq, Bitboard occupied) {
+    return (pawnAttacks(PieceColor::Black, sq) & state.bb(PieceColor::White, PieceType::Pawn))
+        | (pawnAttacks(PieceColor::White, sq) & state.bb(PieceColor::Black, PieceType::Pawn))
+        | (knightAttacks(sq) & state.typeBB(PieceType::Knight))
+        | (kingAttacks(sq) & state.typeBB(PieceType::King))
+        | (rookAttacks(sq, occupied) & (state.typeBB(PieceType::Rook) | state.typeBB(PieceType::Queen)))
+        | (bishopAttacks(sq, occupied) & (state.typeBB(PieceType::Bishop) | state.typeBB(PieceType::Queen)));
+}
+
+bool isSquareAttacked(const BoardState& state, Square sq, PieceColor by) {
+    return (attackersTo(state, sq, state.occupied) & state.colorBB(by)) != 0;
+}
+
+bool inCheck(const BoardState& state) {
+    Square ksq = state.kingSquare(state.sideToMove);
+    return ksq != NoSquare && isSquareAttacked(state, ksq, ~state.sideToMove);
+}
+
+template <GenType Type>
+void generateMoves(const BoardState& state, MoveList& list) {
+    if (state.sideToMove == PieceColor::White) generateAll<PieceColor::White, Type>(state, list);
+    else generateAll<PieceColor::Black, Type>(state, list);
+}
+
+template void generateMoves<GenType::Captures>(const BoardState& state, MoveList& list);
+template void generateMoves<GenType::Quiets>(const BoardState& state, MoveList& list);
+template void generateMoves<GenType::Evasions>(const BoardState& state, MoveList& list);
+template void generateMoves<GenType::Legal>(const BoardState& state, MoveList& list);
+
+std::string moveToString(Move m) {
+    std::string s = {
+        static_cast<char>('a' + fileOf(m.from())), static_cast<char>('1' + rankOf(m.from())),
+        static_cast<char>('a' + fileOf(m.to())), static_cast<char>('1' + rankOf(m.to()))
+    };
+    if (m.flags() & PromotionMove)
+        s += "qrbn"[typeIndex(m.promotion()) - typeIndex(PieceType::Queen)];
+    return s;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "bitboard.h"
+#include "boardstate.h"
+
+#include <string>
+#include <utility>
+
+// Fixed-capacity move buffer; 256 exceeds the largest known move count of
+// any reachable position.
+struct MoveList {
+    Move moves[256];
+    int count = 0;
+
+    void add(Square from, Square to, uint8_t flags = QuietMove, PieceType promotion = PieceType::None) {
+        moves[count++] = Move(from, to, flags, promotion);
+    }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    Move* begin() { return moves; }
+    Move* end() { return moves + count; }
+    const Move* begin() const { return moves; }
+    const Move* end() const { return moves + count; }
+    const Move& operator[](int i) const { return moves[i]; }
+};
+
+struct ScoredMove {
+    Move move;
+    int score;
+};
+
+// Moves paired with their ordering scores, so selecting the next move
+// swaps one 8-byte entry instead of two parallel arrays.
+struct ScoredMoveList {
+    ScoredMove moves[256];
+    int count = 0;
+
+    void add(Move m, int score) { moves[count++] = { m, score }; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    ScoredMove& operator[](int i) { return moves[i]; }
+    const ScoredMove& operator[](int i) const { return moves[i]; }
+
+    // Selection sort step: swaps the best-scored move of [i, count) into
+    // slot i and returns it. Cheaper than a full sort when a cutoff comes
+    // early.
+    Move pickNext(int i) {
+        int best = i;
+        for (int j = i + 1; j < count; ++j)
+            if (moves[j].score > moves[best].score) best = j;
+        std::swap(moves[i], moves[best]);
+        return moves[i].move;
+    }
+};
+
+// Pieces of either colour attacking sq, given the occupancy to use for
+// sliding rays.
+Bitboard attackersTo(const BoardState& state, Square sq, Bitboard occupied);
+bool isSquareAttacked(const BoardState& state, Square sq, PieceColor by);
+bool inCheck(const BoardState& state);
+
+enum class GenType : uint8_t {
+    Captures,   // captures and queen promotions, as quiescence searches them
+    Quiets,     // everything else, castling and under-promotions included
+    Evasions,   // every legal move when in check
+    Legal       // every legal move
+};
+
+// Fills list with the legal moves of the given type for the side to move,
+// specialised per colour so pawn directions, promotion ranks and castling
+// squares are constants. Checkers and pinned pieces are computed once up
+// front, so no move has to be tried on the board. Captures and Quiets
+// together are exactly the Legal moves.
+template <GenType Type>
+void generateMoves(const BoardState& state, MoveList& list);
+
+inline void generateLegalMoves(const BoardState& state, MoveList& list) { generateMoves<GenType::Legal>(state, list); }
+
+template <PieceColor C>
+inline Bitboard pawnTargets(const BoardState& state, Square from) {
+    constexpr int Up = C == PieceColor::White ? 8 : -8;
+    constexpr int StartRank = C == PieceColor::White ? 1 : 6;
+    Bitboard targets = 0;
+    Square to = from + Up;
+    if (to >= 0 && to < 64 && state.isEmpty(to)) {
+        targets |= squareBB(to);
+        if (rankOf(from) == StartRank && state.isEmpty(to + Up))
+            targets |= squareBB(to + Up);
+    }
+    Bitboard victims = state.colorBB(~C);
+    if (state.epSquare != NoSquare) victims |= squareBB(state.epSquare);
+    return targets | (pawnAttacks(C, from) & victims);
+}
+
+// Pseudo-legal destinations of a piece of type T and colour c standing on
+// from: the piece's own movement rules only, ignoring pins, checks and
+// castling. This backs the Piece::isMoveValid compatibility facade.
+template <PieceType T>
+inline Bitboard pieceTargets(const BoardState& state, Square from, PieceColor c) {
+    if constexpr (T == PieceType::None) {
+        return 0;
+    }
+    else if constexpr (T == PieceType::Pawn) {
+        return c == PieceColor::White ? pawnTargets<PieceColor::White>(state, from)
+                                      : pawnTargets<PieceColor::Black>(state, from);
+    }
+    else {
+        return attacks<T>(from, state.occupied) & ~state.colorBB(c);
+    }
+}
+
+using PieceTargetsFn = Bitboard (*)(const BoardState&, Square, PieceColor);
+
+// Indexed by PieceType, so callers holding a PieceCode dispatch without a
+// virtual call or a switch.
+inline constexpr PieceTargetsFn PieceTargetTable[7] = {
+    &pieceTargets<PieceType::King>, &pieceTargets<PieceType::Queen>, &pieceTargets<PieceType::Rook>,
+    &pieceTargets<PieceType::Bishop>, &pieceTargets<PieceType::Knight>, &pieceTargets<PieceType::Pawn>,
+    &pieceTargets<PieceType::None>
+};
+
+inline Bitboard pieceTargets(const BoardState& state, Square from) {
+    PieceCode p = state.pieceAt(from);
+    return PieceTargetTable[typeIndex(pieceType(p))](state, from, pieceColor(p));
+}
+
+// Coordinate notation as used by UCI, e.g. "e2e4" or "e7e8q".
+std::string moveToString(Move m);
@@ -0,0 +1,272 @@
+#include "nnue.h"
+
+#include "search.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if !defined(NNUE_SCALAR)
+#if defined(_M_X64) || defined(__x86_64__)
+#define NNUE_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define NNUE_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+// GCC and Clang only emit AVX instructions in functions that ask for them;
+// MSVC accepts the intrinsics anywhere.
+#if defined(NNUE_X86) && defined(__GNUC__)
+#define NNUE_TARGET(isa) __attribute__((target(isa)))
+#else
+#define NNUE_TARGET(isa)
+#endif
+
+namespace Nnue {
+
+namespace {
+
+struct Kernels {
+    void (*add)(int16_t* acc, const int16_t* row);
+    void (*sub)(int16_t* acc, const int16_t* row);
+    // Sum of clipped accumulator values times output weights.
+    int32_t (*dot)(const int16_t* acc, const int16_t* weights);
+    const char* name;
+};
+
+void addScalar(int16_t* acc, const int16_t* row) {
+    for (int i = 0; i < Hidden; ++i) acc[i] = static_cast<int16_t>(acc[i] + row[i]);
+}
+void subScalar(int16_t* acc, const int16_t* row) {
+    for (int i = 0; i < Hidden; ++i) acc[i] = static_cast<int16_t>(acc[i] - row[i]);
+}
+int32_t dotScalar(const int16_t* acc, const int16_t* weights) {
+    int32_t sum = 0;
+    for (int i = 0; i < Hidden; ++i) sum += std::clamp<int>(acc[i], 0, ClipMax) * weights[i];
+    return sum;
+}
+
+#if defined(NNUE_X86)
+
+NNUE_TARGET("avx2") void addAvx2(int16_t* acc, const int16_t* row) {
+    for (int i = 0; i < Hidden; i += 16) {
+        __m256i* a = reinterpret_cast<__m256i*>(acc + i);
+        _mm256_storeu_si256(a, _mm256_add_epi16(_mm256_loadu_si256(a), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i))));
+    }
+}
+NNUE_TARGET("avx2") void subAvx2(int16_t* acc, const int16_t* row) {
+    for (int i = 0; i < Hidden; i += 16) {
+        __m256i* a = reinterpret_cast<__m256i*>(acc + i);
+        _mm256_storeu_si256(a, _mm256_sub_epi16(_mm256_loadu_si256(a), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i))));
+    }
+}
+NNUE_TARGET("avx2") int32_t dotAvx2(const int16_t* acc, const int16_t* weights) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i clip = _mm256_set1_epi16(ClipMax);
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < Hidden; i += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + i));
+        v = _mm256_min_epi16(_mm256_max_epi16(v, zero), clip);
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i))));
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+    return _mm_cvtsi128_si32(s);
+}
+
+NNUE_TARGET("avx512f,avx512bw") void addAvx512(int16_t* acc, const int16_t* row) {
+    for (int i = 0; i < Hidden; i += 32)
+        _mm512_storeu_si512(acc + i, _mm512_add_epi16(_mm512_loadu_si512(acc + i), _mm512_loadu_si512(row + i)));
+}
+NNUE_TARGET("avx512f,avx512bw") void subAvx512(int16_t* acc, const int16_t* row) {
+    for (int i = 0; i < Hidden; i += 32)
+        _mm512_storeu_si512(acc + i, _mm512_sub_epi16(_mm512_loadu_si512(acc + i), _mm512_loadu_si512(row + i)));
+}
+NNUE_TARGET("avx512f,avx512bw") int32_t dotAvx512(const int16_t* acc, const int16_t* weights) {
+    const __m512i zero = _mm512_set1_epi16(0);
+    const __m512i clip = _mm512_set1_epi16(ClipMax);
+    __m512i sum = _mm512_set1_epi32(0);
+    for (int i = 0; i < Hidden; i += 32) {
+        __m512i v = _mm512_min_epi16(_mm512_max_epi16(_mm512_loadu_si512(acc + i), zero), clip);
+        sum = _mm512_add_epi32(sum, _mm512_madd_epi16(v, _mm512_loadu_si512(weights + i)));
+    }
+    alignas(64) int32_t lanes[16];
+    _mm512_store_si512(lanes, sum);
+    int32_t total = 0;
+    for (int32_t lane : lanes) total += lane;
+    return total;
+}
+
+void cpuid(unsigned leaf, unsigned sub, unsigned regs[4]) {
+#if defined(_MSC_VER)
+    __cpuidex(reinterpret_cast<int*>(regs), static_cast<int>(leaf), static_cast<int>(sub));
+#else
+    __cpuid_count(leaf, sub, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// Register state the OS saves on context switches (XCR0).
+uint64_t enabledStateMask() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned lo, hi;
+    __asm__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return uint64_t(hi) << 32 | lo;
+#endif
+}
+
+#elif defined(NNUE_NEON)
+
+void addNeon(int16_t* acc, const int16_t* row) {
+    for (int i = 0; i < Hidden; i += 8) vst1q_s16(acc + i, vaddq_s16(vld1q_s16(acc + i), vld1q_s16(row + i)));
+}
+void subNeon(int16_t* acc, const int16_t* row) {
+    for (int i = 0; i < Hidden; i += 8) vst1q_s16(acc + i, vsubq_s16(vld1q_s16(acc + i), vld1q_s16(row + i)));
+}
+int32_t dotNeon(const int16_t* acc, const int16_t* weights) {
+    const int16x8_t zero = vdupq_n_s16(0);
+    const int16x8_t clip = vdupq_n_s16(ClipMax);
+    int32x4_t sum = vdupq_n_s32(0);
+    for (int i = 0; i < Hidden; i += 8) {
+        int16x8_t v = vminq_s16(vmaxq_s16(vld1q_s16(acc + i), zero), clip);
+        int16x8_t w = vld1q_s16(weights + i);
+        sum = vmlal_s16(sum, vget_low_s16(v), vget_low_s16(w));
+        sum = vmlal_s16(sum, vget_high_s16(v), vget_high_s16(w));
+    }
+    return vaddvq_s32(sum);
+}
+
+#endif
+
+Kernels detectKernels() {
+#if defined(NNUE_X86)
+    unsigned regs[4];
+    cpuid(0, 0, regs);
+    unsigned maxLeaf = regs[0];
+    cpuid(1, 0, regs);
+    bool osxsave = (regs[2] >> 27) & 1;
+    if (osxsave && maxLeaf >= 7) {
+        uint64_t xcr0 = enabledStateMask();
+        cpuid(7, 0, regs);
+        bool avx2 = (regs[1] >> 5) & 1;
+        bool avx512 = ((regs[1] >> 16) & 1) && ((regs[1] >> 30) & 1);
+        if (avx512 && (xcr0 & 0xE6) == 0xE6) return { addAvx512, subAvx512, dotAvx512, "avx512" };
+        if (avx2 && (xcr0 & 0x6) == 0x6) return { addAvx2, subAvx2, dotAvx2, "avx2" };
+    }
+#elif defined(NNUE_NEON)
+    return { addNeon, subNeon, dotNeon, "neon" };
+#endif
+    return { addScalar, subScalar, dotScalar, "scalar" };
+}
+
+const Kernels& kernels() {
+    static const Kernels k = detectKernels();
+    return k;
+}
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t features;
+    uint32_t hidden;
+};
+
+constexpr char Magic[8] = { 'C', 'H', '1', 'N', 'N', 'U', 'E', '\0' };
+constexpr size_t HeaderSize = 64;
+constexpr size_t BiasOffset = HeaderSize;
+constexpr size_t WeightsOffset = BiasOffset + Hidden * sizeof(int16_t);
+constexpr size_t OutputOffset = WeightsOffset + size_t(Features) * Hidden * sizeof(int16_t);
+constexpr size_t OutBiasOffset = OutputOffset + 2 * Hidden * sizeof(int16_t);
+constexpr size_t FileSize = OutBiasOffset + sizeof(int32_t);
+
+} // namespace
+
+std::shared_ptr<const Network> Network::load(const char* path) {
+    auto net = std::make_shared<Network>();
+    if (!net->file.open(path) || net->file.size() != FileSize) return nullptr;
+    const uint8_t* base = net->file.data();
+    Header h;
+    std::memcpy(&h, base, sizeof(h));
+    if (std::memcmp(h.magic, Magic, sizeof(Magic)) || h.version != Version
+        || h.features != uint32_t(Features) || h.hidden != uint32_t(Hidden))
+        return nullptr;
+    net->bias = reinterpret_cast<const int16_t*>(base + BiasOffset);
+    net->weights = reinterpret_cast<const int16_t*>(base + WeightsOffset);
+    net->output = reinterpret_cast<const int16_t*>(base + OutputOffset);
+    std::memcpy(&net->outBias, base + OutBiasOffset, sizeof(int32_t));
+    return net;
+}
+
+const char* simdName() { return kernels().name; }
+
+} // namespace Nnue
+
+namespace {
+
+int featureIndex(PieceColor perspective, Square orientedKing, PieceColor color, PieceType type, Square sq) {
+    int flip = perspective == PieceColor::White ? 0 : 56;
+    int relative = color == perspective ? 0 : 1;
+    return orientedKing * Nnue::PieceFeatures + (relative * 6 + typeIndex(type)) * 64 + (sq ^ flip);
+}
+
+} // namespace
+
+NnueEvaluator::NnueEvaluator(std::shared_ptr<const Nnue::Network> net)
+    : network(std::move(net)), cache(2 * 64) {
+    // An empty piece set makes the first visit of every slot a full refresh.
+    for (Accumulator& acc : cache) {
+        std::memcpy(acc.values, network->featureBias(), sizeof(acc.values));
+        std::memset(acc.pieces, 0, sizeof(acc.pieces));
+    }
+}
+
+const int16_t* NnueEvaluator::update(const BoardState& state, PieceColor perspective) {
+    const Nnue::Network& net = *network;
+    const auto& k = Nnue::kernels();
+    Square king = state.kingSquare(perspective);
+    if (king == NoSquare) king = 0;
+    Square orientedKing = perspective == PieceColor::White ? king : king ^ 56;
+    Accumulator& acc = cache[colorIndex(perspective) * 64 + orientedKing];
+
+    for (int c = 0; c < 2; ++c)
+        for (int t = 0; t < 6; ++t) {
+            Bitboard now = state.pieces[c][t];
+            Bitboard& was = acc.pieces[c][t];
+            PieceColor color = static_cast<PieceColor>(c);
+            PieceType type = static_cast<PieceType>(t);
+            for (Bitboard b = now & ~was; b;)
+                k.add(acc.values, net.featureWeights(featureIndex(perspective, orientedKing, color, type, popLsb(b))));
+            for (Bitboard b = was & ~now; b;)
+                k.sub(acc.values, net.featureWeights(featureIndex(perspective, orientedKing, color, type, popLsb(b))));
+            was = now;
+        }
+    return acc.values;
+}
+
+int NnueEvaluator::evaluate(const BoardState& state) {
+    const auto& k = Nnue::kernels();
+    PieceColor us = state.sideToMove;
+    const int16_t* ours = update(state, us);
+    const int16_t* theirs = update(state, ~us);
+    int64_t out = int64_t(k.dot(ours, network->outputWeights()))
+                  + k.dot(theirs, network->outputWeights() + Nnue::Hidden) + network->outputBias();
+    out = out * Nnue::OutputScale / (Nnue::ClipMax * Nnue::WeightScale);
+    // Keep arbitrary networks clear of the tablebase and mate score range.
+    return static_cast<int>(std::clamp<int64_t>(out, -ValueTBWinInMaxPly + 1, ValueTBWinInMaxPly - 1));
+}
+
+std::unique_ptr<Evaluator> makeEvaluator(const std::string& evalFile, bool* usedNetwork) {
+    std::shared_ptr<const Nnue::Network> net;
+    if (!evalFile.empty()) net = Nnue::Network::load(evalFile.c_str());
+    if (usedNetwork) *usedNetwork = net != nullptr;
+    if (net) return std::make_unique<NnueEvaluator>(std::move(net));
+    return std::make_unique<TaperedEvaluator>();
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "evaluate.h"
+#include "mappedfile.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Efficiently updatable neural network evaluation.
+//
+// Architecture: HalfKA features (king square x piece colour relative to the
+// perspective x piece type x square, kings included, both oriented so the
+// perspective plays up the board) feed a Hidden-wide int16 accumulator per
+// side. The side to move's and the opponent's accumulators are clipped to
+// [0, ClipMax] and joined by a single int16 output layer.
+//
+// Network file layout, little-endian, every section starting on a 64-byte
+// boundary:
+//   header    64 bytes: "CH1NNUE\0", uint32 version, uint32 features,
+//             uint32 hidden, zero padding
+//   int16     feature transformer biases [Hidden]
+//   int16     feature transformer weights [Features][Hidden]
+//   int16     output weights [2 * Hidden], side to move first
+//   int32     output bias
+namespace Nnue {
+
+constexpr int PieceFeatures = 2 * 6 * 64;
+constexpr int Features = 64 * PieceFeatures;
+constexpr int Hidden = 256;
+constexpr uint32_t Version = 1;
+// Quantisation: activations are clipped to ClipMax, output weights are
+// scaled by WeightScale, and the result is mapped to centipawns by
+// OutputScale / (ClipMax * WeightScale).
+constexpr int ClipMax = 255;
+constexpr int WeightScale = 64;
+constexpr int OutputScale = 400;
+
+// Weights stay in the mapped file; one Network is shared by every thread.
+class Network {
+public:
+    // Maps path and validates the header and size; nullptr on failure.
+    static std::shared_ptr<const Network> load(const char* path);
+
+    const int16_t* featureBias() const { return bias; }
+    const int16_t* featureWeights(int feature) const { return weights + size_t(feature) * Hidden; }
+    const int16_t* outputWeights() const { return output; }
+    int32_t outputBias() const { return outBias; }
+
+private:
+    MappedFile file;
+    const int16_t* bias = nullptr;
+    const int16_t* weights = nullptr;
+    const int16_t* output = nullptr;
+    int32_t outBias = 0;
+};
+
+// Name of the kernel set picked for this CPU, e.g. "avx2".
+const char* simdName();
+
+} // namespace Nnue
+
+// Keeps one accumulator per perspective and king square together with the
+// pieces it was last computed for. Evaluating a position only applies the
+// features that changed since that king square was last seen, which between
+// neighbouring search nodes is the handful touched by make/unmake.
+class NnueEvaluator : public Evaluator {
+public:
+    explicit NnueEvaluator(std::shared_ptr<const Nnue::Network> network);
+
+    int evaluate(const BoardState& state) override;
+    std::unique_ptr<Evaluator> clone() const override { return std::make_unique<NnueEvaluator>(network); }
+
+private:
+    struct alignas(64) Accumulator {
+        int16_t values[Nnue::Hidden];
+        Bitboard pieces[2][6];
+    };
+
+    const int16_t* update(const BoardState& state, PieceColor perspective);
+
+    std::shared_ptr<const Nnue::Network> network;
+    std::vector<Accumulator> cache;   // [perspective][oriented king square]
+};
+
+// The network evaluator when evalFile names a loadable network, otherwise the
+// handcrafted one; usedNetwork reports which was built.
+std::unique_ptr<Evaluator> makeEvaluator(const std::string& evalFile, bool* usedNetwork = nullptr);
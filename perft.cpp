@@ -0,0 +1,119 @@
+#include "perft.h"
+
+#include "movegen.h"
+
+#include <chrono>
+#include <cstdio>
+
+namespace {
+
+struct PerftCase {
+    const char* name;
+    const char* fen;
+    uint64_t nodes[6];   // depths 1..6, 0 where not listed
+};
+
+// Reference counts from the Chess Programming Wiki "Perft Results" page.
+const PerftCase PerftSuite[] = {
+    { "startpos", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+      { 20, 400, 8902, 197281, 4865609, 119060324 } },
+    { "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+      { 48, 2039, 97862, 4085603, 193690690, 0 } },
+    { "position3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+      { 14, 191, 2812, 43238, 674624, 11030083 } },
+    { "position4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+      { 6, 264, 9467, 422333, 15833292, 706045033 } },
+    { "position4-mirrored", "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1",
+      { 6, 264, 9467, 422333, 15833292, 706045033 } },
+    { "position5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+      { 44, 1486, 62379, 2103487, 89941194, 0 } },
+    { "position6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+      { 46, 2079, 89890, 3894594, 164075551, 0 } },
+};
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+uint64_t nodesPerSecond(uint64_t nodes, double seconds) {
+    return seconds > 0 ? static_cast<uint64_t>(nodes / seconds) : 0;
+}
+
+} // namespace
+
+uint64_t perft(BoardState& state, int depth) {
+    MoveList moves;
+    generateLegalMoves(state, moves);
+    // Bulk counting: the legal move count is the leaf count one ply down.
+    if (depth <= 1) return depth == 1 ? moves.size() : 1;
+    uint64_t nodes = 0;
+    for (const Move& m : moves) {
+        Undo undo = state.makeMove(m);
+        nodes += perft(state, depth - 1);
+        state.unmakeMove(undo);
+    }
+    return nodes;
+}
+
+bool runPerft(const char* fen, int depth) {
+    BoardState state;
+    if (!state.setFEN(fen)) {
+        std::printf("invalid FEN: %s\n", fen);
+        return false;
+    }
+
+    for (int d = 1; d <= depth; ++d) {
+        auto start = Clock::now();
+        uint64_t nodes = perft(state, d);
+        double elapsed = secondsSince(start);
+        std::printf("depth %d  nodes %llu  time %.3fs  nps %llu\n", d,
+            static_cast<unsigned long long>(nodes), elapsed,
+            static_cast<unsigned long long>(nodesPerSecond(nodes, elapsed)));
+    }
+
+    MoveList moves;
+    generateLegalMoves(state, moves);
+    uint64_t total = 0;
+    auto start = Clock::now();
+    std::printf("\ndivide at depth %d\n", depth);
+    for (const Move& m : moves) {
+        Undo undo = state.makeMove(m);
+        uint64_t nodes = depth > 1 ? perft(state, depth - 1) : 1;
+        state.unmakeMove(undo);
+        total += nodes;
+        std::printf("%s: %llu\n", moveToString(m).c_str(), static_cast<unsigned long long>(nodes));
+    }
+    double elapsed = secondsSince(start);
+    std::printf("\nmoves %d  nodes %llu  time %.3fs  nps %llu\n", moves.size(),
+        static_cast<unsigned long long>(total), elapsed,
+        static_cast<unsigned long long>(nodesPerSecond(total, elapsed)));
+    return true;
+}
+
+bool runPerftSuite(int maxDepth) {
+    bool allPassed = true;
+    uint64_t totalNodes = 0;
+    auto suiteStart = Clock::now();
+    for (const PerftCase& c : PerftSuite) {
+        BoardState state;
+        state.setFEN(c.fen);
+        for (int d = 1; d <= maxDepth && d <= 6 && c.nodes[d - 1]; ++d) {
+            auto start = Clock::now();
+            uint64_t nodes = perft(state, d);
+            double elapsed = secondsSince(start);
+            bool ok = nodes == c.nodes[d - 1];
+            allPassed = allPassed && ok;
+            totalNodes += nodes;
+            std::printf("%-20s depth %d  nodes %12llu  expected %12llu  nps %11llu  %s\n", c.name, d,
+                static_cast<unsigned long long>(nodes), static_cast<unsigned long long>(c.nodes[d - 1]),
+                static_cast<unsigned long long>(nodesPerSecond(nodes, elapsed)), ok ? "ok" : "FAIL");
+        }
+    }
+    double elapsed = secondsSince(suiteStart);
+    std::printf("\ntotal nodes %llu  time %.3fs  nps %llu  %s\n", static_cast<unsigned long long>(totalNodes),
+        elapsed, static_cast<unsigned long long>(nodesPerSecond(totalNodes, elapsed)),
+        allPassed ? "all passed" : "MISMATCH");
+    return allPassed;
+}
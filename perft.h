@@ -0,0 +1,16 @@
+#pragma once
+
+#include "boardstate.h"
+
+#include <cstdint>
+
+// Number of leaf nodes of the legal move tree of the given depth.
+uint64_t perft(BoardState& state, int depth);
+
+// Prints node counts and nodes/sec for depths 1..depth, then a per-root-move
+// divide at the final depth. Returns false if fen does not parse.
+bool runPerft(const char* fen, int depth);
+
+// Runs the reference positions up to maxDepth and compares against their
+// published node counts. Returns true if every count matched.
+bool runPerftSuite(int maxDepth);
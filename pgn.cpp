@@ -0,0 +1,366 @@
+#include "pgn.h"
+
+#include "movegen.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+constexpr size_t ReadChunk = size_t(1) << 20;
+constexpr const char* SANPieces = "KQRBN";
+
+bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+PieceType pieceFromLetter(char c) {
+    const char* p = c ? std::strchr(SANPieces, c) : nullptr;
+    return p ? static_cast<PieceType>(p - SANPieces) : PieceType::None;
+}
+
+bool isResult(const char* p, const char* end) {
+    size_t n = end - p;
+    return (n == 1 && *p == '*')
+        || (n == 3 && (!std::memcmp(p, "1-0", 3) || !std::memcmp(p, "0-1", 3)))
+        || (n == 7 && !std::memcmp(p, "1/2-1/2", 7));
+}
+
+} // namespace
+
+std::string moveToSAN(const BoardState& state, Move m) {
+    std::string san;
+    if (m.flags() & CastlingMove) {
+        san = fileOf(m.to()) == 6 ? "O-O" : "O-O-O";
+    }
+    else {
+        PieceType type = state.typeAt(m.from());
+        bool capture = (m.flags() & CaptureMove) != 0;
+        if (type == PieceType::Pawn) {
+            if (capture) san += static_cast<char>('a' + fileOf(m.from()));
+        }
+        else {
+            san += SANPieces[typeIndex(type)];
+            // Disambiguate against other pieces of the same kind that can
+            // reach the target: by file if it is unique, else by rank, else both.
+            MoveList moves;
+            generateLegalMoves(state, moves);
+            bool ambiguous = false, fileClash = false, rankClash = false;
+            for (const Move& other : moves) {
+                if (other.to() != m.to() || other.from() == m.from() || state.typeAt(other.from()) != type) continue;
+                ambiguous = true;
+                fileClash |= fileOf(other.from()) == fileOf(m.from());
+                rankClash |= rankOf(other.from()) == rankOf(m.from());
+            }
+            if (ambiguous) {
+                if (!fileClash) san += static_cast<char>('a' + fileOf(m.from()));
+                else if (!rankClash) san += static_cast<char>('1' + rankOf(m.from()));
+                else {
+                    san += static_cast<char>('a' + fileOf(m.from()));
+                    san += static_cast<char>('1' + rankOf(m.from()));
+                }
+            }
+        }
+        if (capture) san += 'x';
+        san += static_cast<char>('a' + fileOf(m.to()));
+        san += static_cast<char>('1' + rankOf(m.to()));
+        if (m.flags() & PromotionMove) {
+            san += '=';
+            san += SANPieces[typeIndex(m.promotion())];
+        }
+    }
+    BoardState after = state;
+    after.makeMove(m);
+    if (inCheck(after)) {
+        MoveList replies;
+        generateLegalMoves(after, replies);
+        san += replies.empty() ? '#' : '+';
+    }
+    return san;
+}
+
+Move parseSAN(const BoardState& state, const char* san, const char* end) {
+    while (end > san && std::strchr("+#!?", end[-1])) --end;
+    if (end - san < 2) return NoMove;
+
+    MoveList moves;
+    generateLegalMoves(state, moves);
+
+    if (*san == 'O' || *san == '0') {
+        size_t n = end - san;
+        int kingFile;
+        if (n == 3 && (!std::memcmp(san, "O-O", 3) || !std::memcmp(san, "0-0", 3))) kingFile = 6;
+        else if (n == 5 && (!std::memcmp(san, "O-O-O", 5) || !std::memcmp(san, "0-0-0", 5))) kingFile = 2;
+        else return NoMove;
+        for (const Move& m : moves)
+            if ((m.flags() & CastlingMove) && fileOf(m.to()) == kingFile) return m;
+        return NoMove;
+    }
+
+    PieceType type = PieceType::Pawn;
+    if (pieceFromLetter(*san) != PieceType::None) type = pieceFromLetter(*san++);
+
+    PieceType promotion = PieceType::None;
+    if (end - san >= 2 && pieceFromLetter(end[-1]) != PieceType::None) {
+        promotion = pieceFromLetter(end[-1]);
+        --end;
+        if (end[-1] == '=') --end;
+    }
+    if (end - san < 2) return NoMove;
+    int toFile = end[-2] - 'a', toRank = end[-1] - '1';
+    if (toFile < 0 || toFile > 7 || toRank < 0 || toRank > 7) return NoMove;
+    Square to = makeSquare(toFile, toRank);
+
+    // Whatever is left between the piece letter and the target square is
+    // disambiguation and an optional capture mark.
+    int fromFile = -1, fromRank = -1;
+    for (const char* p = san; p < end - 2; ++p) {
+        if (*p >= 'a' && *p <= 'h') fromFile = *p - 'a';
+        else if (*p >= '1' && *p <= '8') fromRank = *p - '1';
+        else if (*p != 'x' && *p != ':' && *p != '-') return NoMove;
+    }
+
+    Move found = NoMove;
+    for (const Move& m : moves) {
+        if (m.to() != to || state.typeAt(m.from()) != type) continue;
+        if (fromFile >= 0 && fileOf(m.from()) != fromFile) continue;
+        if (fromRank >= 0 && rankOf(m.from()) != fromRank) continue;
+        if (m.promotion() != (promotion == PieceType::None && (m.flags() & PromotionMove) ? PieceType::Queen : promotion))
+            continue;
+        if (found != NoMove) return NoMove;
+        found = m;
+    }
+    return found;
+}
+
+void PgnGame::clear() {
+    tags.clear();
+    start.setStartPosition();
+    moves.clear();
+    result = "*";
+}
+
+const std::string* PgnGame::tag(const char* name) const {
+    for (const auto& t : tags)
+        if (t.first == name) return &t.second;
+    return nullptr;
+}
+
+void PgnParser::startGame() {
+    game.clear();
+    position = game.start;
+    inGame = true;
+    failed = false;
+}
+
+void PgnParser::endGame() {
+    if (!inGame) return;
+    inGame = false;
+    if (failed) {
+        ++counters.errors;
+        return;
+    }
+    ++counters.games;
+    counters.moves += game.moves.size();
+    visit(game);
+}
+
+void PgnParser::tagLine(const char* p, const char* end) {
+    // A tag after movetext means the previous game had no result token.
+    if (inGame && (!game.moves.empty() || failed)) endGame();
+    if (!inGame) startGame();
+
+    ++p;
+    const char* name = p;
+    while (p < end && !isSpace(*p) && *p != '"' && *p != ']') ++p;
+    std::string tagName(name, p);
+    while (p < end && *p != '"') ++p;
+    std::string value;
+    for (++p; p < end && *p != '"'; ++p) {
+        if (*p == '\\' && p + 1 < end) ++p;
+        value += *p;
+    }
+    if (tagName == "FEN") {
+        if (game.start.setFEN(value.c_str())) position = game.start;
+        else failed = true;
+    }
+    game.tags.emplace_back(std::move(tagName), std::move(value));
+}
+
+void PgnParser::token(const char* p, const char* end) {
+    if (isResult(p, end)) {
+        if (!inGame) startGame();
+        game.result.assign(p, end);
+        endGame();
+        return;
+    }
+    // Move numbers, possibly glued to the move: "12.", "12...", "12.e4".
+    while (p < end && *p >= '0' && *p <= '9') ++p;
+    while (p < end && *p == '.') ++p;
+    if (p == end) return;
+    // Symbolic annotations such as "+-" or "!?" written as separate tokens.
+    if (std::all_of(p, end, [](char c) { return std::strchr("+-=/!?", c) != nullptr; })) return;
+
+    if (!inGame) startGame();
+    if (failed) return;
+    Move m = parseSAN(position, p, end);
+    if (m == NoMove) {
+        failed = true;
+        return;
+    }
+    position.makeMove(m);
+    game.moves.push_back(m);
+}
+
+void PgnParser::feed(const char* p, const char* end) {
+    counters.bytes += end - p;
+    bool lineStart = true;
+    while (p < end) {
+        char c = *p;
+        if (inComment) {
+            if (c == '}') inComment = false;
+            lineStart = c == '\n';
+            ++p;
+            continue;
+        }
+        if (c == '\n') {
+            lineStart = true;
+            ++p;
+            continue;
+        }
+        if (isSpace(c)) {
+            ++p;
+            continue;
+        }
+        if (c == '{') {
+            inComment = true;
+            ++p;
+            continue;
+        }
+        // Rest-of-line comments, and '%' escape lines.
+        if (c == ';' || (c == '%' && lineStart)) {
+            while (p < end && *p != '\n') ++p;
+            continue;
+        }
+        lineStart = false;
+        if (c == '(') {
+            ++variationDepth;
+            ++p;
+            continue;
+        }
+        if (c == ')') {
+            if (variationDepth) --variationDepth;
+            ++p;
+            continue;
+        }
+        if (variationDepth) {
+            ++p;
+            continue;
+        }
+        if (c == '[') {
+            const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            if (!eol) eol = end;
+            tagLine(p, eol);
+            p = eol;
+            continue;
+        }
+        if (c == '$') {
+            for (++p; p < end && *p >= '0' && *p <= '9'; ++p) {}
+            continue;
+        }
+        const char* start = p;
+        while (p < end && !isSpace(*p) && !std::strchr("{}();[$", *p)) ++p;
+        token(start, p);
+    }
+}
+
+void PgnParser::finish() {
+    if (inGame && (!game.moves.empty() || failed)) endGame();
+    inGame = false;
+    inComment = false;
+    variationDepth = 0;
+}
+
+bool readPgnFile(const char* path, const PgnVisitor& visit, PgnStats* stats) {
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file) return false;
+    auto started = std::chrono::steady_clock::now();
+
+    PgnParser parser(visit);
+    // Whole lines are handed to the parser; the partial last line of a
+    // chunk is carried into the next read.
+    std::vector<char> buffer(ReadChunk * 2);
+    size_t carried = 0;
+    while (true) {
+        if (buffer.size() - carried < ReadChunk) buffer.resize(carried + ReadChunk);
+        size_t n = std::fread(buffer.data() + carried, 1, ReadChunk, file);
+        size_t filled = carried + n;
+        if (n == 0) {
+            parser.feed(buffer.data(), buffer.data() + filled);
+            break;
+        }
+        const char* data = buffer.data();
+        const char* lastNewline = nullptr;
+        for (const char* q = data + filled; q > data; --q)
+            if (q[-1] == '\n') {
+                lastNewline = q - 1;
+                break;
+            }
+        if (!lastNewline) {
+            carried = filled;
+            continue;
+        }
+        parser.feed(data, lastNewline + 1);
+        carried = filled - (lastNewline + 1 - data);
+        std::memmove(buffer.data(), lastNewline + 1, carried);
+    }
+    parser.finish();
+    std::fclose(file);
+
+    if (stats) {
+        *stats = parser.stats();
+        stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    }
+    return true;
+}
+
+void writePgn(std::FILE* out, const PgnGame& game) {
+    BoardState standard;
+    standard.setStartPosition();
+    bool customStart = game.start.key != standard.key || game.start.fullmoveNumber != 1;
+    for (const auto& t : game.tags) {
+        std::fprintf(out, "[%s \"", t.first.c_str());
+        for (char c : t.second) {
+            if (c == '"' || c == '\\') std::fputc('\\', out);
+            std::fputc(c, out);
+        }
+        std::fputs("\"]\n", out);
+    }
+    if (customStart && !game.tag("FEN"))
+        std::fprintf(out, "[SetUp \"1\"]\n[FEN \"%s\"]\n", game.start.toFEN().c_str());
+    std::fputc('\n', out);
+
+    BoardState position = game.start;
+    size_t column = 0;
+    auto emit = [&](const std::string& word) {
+        if (column && column + 1 + word.size() > 79) {
+            std::fputc('\n', out);
+            column = 0;
+        }
+        else if (column) {
+            std::fputc(' ', out);
+            ++column;
+        }
+        std::fputs(word.c_str(), out);
+        column += word.size();
+    };
+    for (size_t i = 0; i < game.moves.size(); ++i) {
+        if (position.sideToMove == PieceColor::White)
+            emit(std::to_string(position.fullmoveNumber) + ".");
+        else if (i == 0)
+            emit(std::to_string(position.fullmoveNumber) + "...");
+        emit(moveToSAN(position, game.moves[i]));
+        position.makeMove(game.moves[i]);
+    }
+    emit(game.result);
+    std::fputs("\n\n", out);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "boardstate.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Standard algebraic notation for a legal move, with check/mate suffix.
+std::string moveToSAN(const BoardState& state, Move m);
+// Decodes the SAN token [san, end) into the legal move it denotes; NoMove
+// if it is malformed, illegal or ambiguous. Annotation suffixes are ignored.
+Move parseSAN(const BoardState& state, const char* san, const char* end);
+
+struct PgnGame {
+    std::vector<std::pair<std::string, std::string>> tags;   // in file order
+    BoardState start;
+    std::vector<Move> moves;
+    std::string result = "*";
+
+    PgnGame() { start.setStartPosition(); }
+    // Keeps the allocated capacity, so a reader reuses one game object.
+    void clear();
+    const std::string* tag(const char* name) const;
+};
+
+struct PgnStats {
+    uint64_t games = 0;
+    uint64_t moves = 0;
+    uint64_t errors = 0;   // games dropped for an unreadable or illegal move
+    uint64_t bytes = 0;
+    double seconds = 0;
+};
+
+using PgnVisitor = std::function<void(const PgnGame&)>;
+
+// Incremental PGN parser. Text is fed in whole lines, in as many pieces as
+// the caller likes; comments and variations may span pieces, tag lines and
+// tokens may not. Variations, comments, NAGs and move numbers are skipped
+// and SAN is replayed on a BoardState as it is read.
+class PgnParser {
+public:
+    explicit PgnParser(PgnVisitor visit) : visit(std::move(visit)) {}
+
+    void feed(const char* begin, const char* end);
+    // Flushes a trailing game that has no result token.
+    void finish();
+    const PgnStats& stats() const { return counters; }
+
+private:
+    void startGame();
+    void endGame();
+    void tagLine(const char* p, const char* end);
+    void token(const char* p, const char* end);
+
+    PgnVisitor visit;
+    PgnGame game;
+    BoardState position;
+    PgnStats counters;
+    bool inGame = false;
+    bool failed = false;
+    bool inComment = false;
+    int variationDepth = 0;
+};
+
+// Streams a file through a fixed read buffer; the file is never held in
+// memory as a whole. False if it cannot be opened.
+bool readPgnFile(const char* path, const PgnVisitor& visit, PgnStats* stats = nullptr);
+
+// Appends one game: tags (adding SetUp/FEN for a non-standard start), then
+// the movetext in SAN wrapped at 80 columns, then the result.
+void writePgn(std::FILE* out, const PgnGame& game);
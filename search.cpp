@@ -0,0 +1,452 @@
+#include "search.h"
+
+#include "tablebase.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+constexpr int TTMoveScore = 1 << 30;
+constexpr int CaptureBase = 1 << 20;
+constexpr int KillerScore = CaptureBase - 1000;
+
+// Selectivity margins, in centipawns.
+constexpr int AspirationDelta = 25;
+constexpr int ReverseFutilityMargin = 80;   // per ply of depth
+constexpr int RazorMargin = 250;            // per ply of depth
+constexpr int FutilityBase = 100;
+constexpr int FutilityMargin = 120;         // per ply of depth
+constexpr int NullMoveVerifyDepth = 12;
+// History is scaled down by this much before it adjusts a reduction.
+constexpr int HistoryReductionScale = 1 << 17;
+// Nodes between clock reads; a power of two.
+constexpr uint64_t TimeCheckInterval = 1024;
+
+bool isNoisy(Move m) {
+    return (m.flags() & CaptureMove) || ((m.flags() & PromotionMove) && m.promotion() == PieceType::Queen);
+}
+
+// Late move reductions grow with the logarithm of both the depth and the
+// move's position in the ordering.
+struct ReductionTable {
+    int8_t r[MaxPly][64];
+
+    ReductionTable() {
+        for (int d = 0; d < MaxPly; ++d)
+            for (int i = 0; i < 64; ++i)
+                r[d][i] = static_cast<int8_t>(d && i ? 0.75 + std::log(d) * std::log(i) / 2.25 : 0);
+    }
+    int operator()(int depth, int moveIndex) const { return r[std::min(depth, MaxPly - 1)][std::min(moveIndex, 63)]; }
+};
+
+const ReductionTable Reductions;
+
+bool hasNonPawnMaterial(const BoardState& state, PieceColor c) {
+    return (state.colorBB(c) & ~state.bb(c, PieceType::Pawn) & ~state.bb(c, PieceType::King)) != 0;
+}
+
+} // namespace
+
+const SearchFeatures::Toggle SearchFeatures::Toggles[7] = {
+    { "NullMove", &SearchFeatures::nullMove },
+    { "LMR", &SearchFeatures::lateMoveReductions },
+    { "Futility", &SearchFeatures::futility },
+    { "ReverseFutility", &SearchFeatures::reverseFutility },
+    { "Razoring", &SearchFeatures::razoring },
+    { "CheckExtensions", &SearchFeatures::checkExtensions },
+    { "AspirationWindows", &SearchFeatures::aspirationWindows },
+};
+
+bool SearchFeatures::set(const std::string& name, bool enabled) {
+    for (const Toggle& t : Toggles)
+        if (name == t.name) {
+            this->*t.flag = enabled;
+            return true;
+        }
+    return false;
+}
+
+int64_t Search::elapsedMs() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - startTime).count();
+}
+
+int64_t Search::clockElapsedMs() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - clockStart).count();
+}
+
+bool Search::awaitingPonderhit() {
+    if (pondering && !ponderFlag->load(std::memory_order_relaxed)) {
+        pondering = false;
+        clockStart = Clock::now();
+    }
+    return pondering;
+}
+
+void Search::clearHistory() {
+    std::memset(history, 0, sizeof(history));
+}
+
+bool Search::shouldStop() {
+    if (stopped()) return true;
+    if (threadId != 0) return false;
+    uint64_t n = nodesSearched();
+    if (limits.nodes && n >= limits.nodes) {
+        stop();
+        return true;
+    }
+    // Reading the clock on every node would dominate small searches.
+    if ((n & (TimeCheckInterval - 1)) == 0 && !awaitingPonderhit() && time.hardLimitReached(clockElapsedMs())) {
+        stop();
+        return true;
+    }
+    return false;
+}
+
+int Search::scoreMove(Move m, int ply, Move ttMove) const {
+    if (m == ttMove) return TTMoveScore;
+    if (isNoisy(m)) {
+        // MVV-LVA: most valuable victim first, cheapest attacker first.
+        PieceType victim = (m.flags() & EnPassantMove) ? PieceType::Pawn : state.typeAt(m.to());
+        int gain = PieceValue[typeIndex(victim)] + ((m.flags() & PromotionMove) ? PieceValue[typeIndex(m.promotion())] : 0);
+        return CaptureBase + gain * 8 - PieceValue[typeIndex(state.typeAt(m.from()))] / 100;
+    }
+    if (m == killers[ply][0]) return KillerScore;
+    if (m == killers[ply][1]) return KillerScore - 1;
+    return history[colorIndex(state.sideToMove)][m.from()][m.to()];
+}
+
+void Search::updateQuietStats(Move m, int depth, int ply) {
+    if (killers[ply][0] != m) {
+        killers[ply][1] = killers[ply][0];
+        killers[ply][0] = m;
+    }
+    int& h = history[colorIndex(state.sideToMove)][m.from()][m.to()];
+    h += depth * depth;
+    // Keep history below the killer band.
+    if (h >= KillerScore / 2) {
+        for (auto& side : history)
+            for (auto& from : side)
+                for (int& v : from) v /= 2;
+    }
+}
+
+SearchResult Search::think(const BoardState& root, const SearchLimits& searchLimits, const KeyHistory* gameKeys) {
+    stopFlag->store(false, std::memory_order_relaxed);
+    ponderFlag->store(searchLimits.ponder, std::memory_order_relaxed);
+    tt.newSearch();
+    return run(root, searchLimits, 0, gameKeys);
+}
+
+SearchResult Search::run(const BoardState& root, const SearchLimits& searchLimits, int id, const KeyHistory* gameKeys) {
+    state = root;
+    keys.clear();
+    if (gameKeys) keys = *gameKeys;
+    if (keys.empty() || keys.top() != root.key) keys.push(root.key);
+    limits = searchLimits;
+    threadId = id;
+    startTime = clockStart = Clock::now();
+    pondering = threadId == 0 && ponderFlag->load(std::memory_order_relaxed);
+    if (threadId != 0) time.disable();
+    else if (limits.movetimeMs) time.startFixed(limits.movetimeMs);
+    else if (limits.timeMs) time.start(limits.timeMs, limits.incrementMs, limits.movesToGo, limits.overheadMs);
+    else time.disable();
+    nodes.store(0, std::memory_order_relaxed);
+    std::fill(&killers[0][0], &killers[0][0] + MaxPly * 2, NoMove);
+    for (auto& side : history)
+        for (auto& from : side)
+            for (int& v : from) v /= 2;
+    stats = SearchStats();
+    uint64_t pawnProbes = evaluator.pawnProbes(), pawnHits = evaluator.pawnHits();
+
+    SearchResult result;
+    rootMoves = MoveList();
+    generateLegalMoves(state, rootMoves);
+    if (rootMoves.empty()) return result;
+    // Within tablebase range only the moves that keep the best result the
+    // tables promise are searched, the quickest conversion first.
+    Tablebases::filterRootMoves(state, rootMoves);
+    result.bestMove = rootMoves[0];
+
+    nullMoveMinPly = 0;
+    int maxDepth = limits.depth > 0 && threadId == 0 ? std::min(limits.depth, MaxPly - 1) : MaxPly - 1;
+    for (int iteration = 1; iteration <= maxDepth; ++iteration) {
+        int depth = std::min(iteration + (threadId & 1), MaxPly - 1);
+        rootDepth = depth;
+        int score;
+        // Aspiration windows: search a narrow window around the previous
+        // score and widen it on the side that failed until the score fits.
+        if (features.aspirationWindows && iteration >= 4 && std::abs(result.score) < ValueTBWinInMaxPly) {
+            int delta = AspirationDelta;
+            int alpha = std::max(result.score - delta, -ValueInfinite);
+            int beta = std::min(result.score + delta, ValueInfinite);
+            while (true) {
+                score = negamax(alpha, beta, depth, 0);
+                if (stopped()) break;
+                if (score <= alpha) {
+                    beta = (alpha + beta) / 2;
+                    alpha = std::max(score - delta, -ValueInfinite);
+                }
+                else if (score >= beta) {
+                    beta = std::min(score + delta, ValueInfinite);
+                }
+                else break;
+                delta *= 2;
+            }
+        }
+        else {
+            score = negamax(-ValueInfinite, ValueInfinite, depth, 0);
+        }
+        // An interrupted iteration is discarded; the previous one stands.
+        if (stopped() && iteration > 1) break;
+
+        result.score = score;
+        result.depth = depth;
+        result.pv.assign(pvTable[0], pvTable[0] + pvLength[0]);
+        if (!result.pv.empty()) result.bestMove = result.pv[0];
+
+        if (onIteration && threadId == 0)
+            onIteration({ depth, score, nodesSearched(), elapsedMs(), result.pv });
+        if (stopped()) break;
+        // A forced mate will not get shorter with more depth.
+        if (std::abs(score) >= ValueMateInMaxPly && ValueMate - std::abs(score) <= depth) break;
+        if (threadId == 0) {
+            // The time manager follows the iterations while pondering too, but
+            // may only end the search once the clock is ours.
+            bool timeUp = time.stopAfterIteration(clockElapsedMs(), result.bestMove, score);
+            if (!awaitingPonderhit()) {
+                if (timeUp) break;
+                // On the clock, a forced reply is not worth thinking about.
+                if (rootMoves.size() == 1 && limits.timeMs && !limits.movetimeMs) break;
+            }
+        }
+    }
+    result.nodes = nodesSearched();
+    result.timeMs = elapsedMs();
+    if constexpr (SearchStats::Enabled) {
+        stats.nodes = result.nodes;
+        stats.pawnProbes = evaluator.pawnProbes() - pawnProbes;
+        stats.pawnHits = evaluator.pawnHits() - pawnHits;
+        result.stats = stats;
+    }
+    return result;
+}
+
+int Search::negamax(int alpha, int beta, int depth, int ply) {
+    pvLength[ply] = 0;
+    bool checked = inCheck(state);
+    // Check extension, bounded so that long checking sequences cannot run
+    // the search to the ply limit.
+    if (checked && features.checkExtensions && ply < 2 * rootDepth) ++depth;
+    if (depth <= 0) return quiescence(alpha, beta, ply);
+
+    countNode();
+    if (ply > 0 && shouldStop()) return 0;
+    // Any repetition inside the tree is scored as a draw: if the line were
+    // good for the side to move it could have deviated the first time.
+    if (ply > 0 && (state.halfmoveClock >= 100 || keys.repetitions(state.halfmoveClock) > 0)) return 0;
+    if (ply >= MaxPly - 1) return evaluate();
+
+    bool pvNode = beta - alpha > 1;
+    int originalAlpha = alpha;
+    Move ttMove = NoMove;
+    TTData tte;
+    countStat(stats.ttProbes);
+    if (tt.probe(state.key, tte)) {
+        countStat(stats.ttHits);
+        ttMove = tte.move;
+        int ttScore = scoreFromTT(tte.score, ply);
+        // PV nodes never cut on the table, so the principal variation stays whole.
+        if (!pvNode && ply > 0 && tte.depth >= depth
+            && (tte.bound == BoundExact
+                || (tte.bound == BoundLower && ttScore >= beta)
+                || (tte.bound == BoundUpper && ttScore <= alpha))) {
+            countStat(stats.ttCutoffs);
+            return ttScore;
+        }
+    }
+
+    // A win or loss only stands if its next zeroing move comes before the
+    // fifty-move count runs out; otherwise the position is a draw. In check
+    // at distance zero may be a mate, which the search scores itself.
+    int dtz;
+    if (ply > 0 && popCount(state.occupied) <= Tablebases::cardinality() && Tablebases::probeDTZ(state, dtz)
+        && (dtz || !checked)) {
+        int score = state.halfmoveClock + std::abs(dtz) > 100 ? 0
+                    : dtz > 0 ? ValueTBWin - ply
+                    : dtz < 0 ? -ValueTBWin + ply
+                    : 0;
+        tt.store(state.key, NoMove, scoreToTT(score, ply), depth, BoundExact);
+        return score;
+    }
+
+    // Static pruning is never applied at PV nodes or in check.
+    int staticEval = -ValueInfinite;
+    if (!pvNode && !checked) {
+        staticEval = evaluate();
+
+        // Reverse futility: far enough above beta that a quiet move will
+        // not bring the score back down.
+        if (features.reverseFutility && depth <= 6 && staticEval - ReverseFutilityMargin * depth >= beta
+            && staticEval < ValueTBWinInMaxPly)
+            return staticEval;
+
+        // Razoring: hopelessly below alpha near the leaves, so only captures
+        // could help; trust quiescence if it agrees.
+        if (features.razoring && depth <= 2 && staticEval + RazorMargin * depth <= alpha) {
+            int score = quiescence(alpha, beta, ply);
+            if (score <= alpha) return score;
+        }
+
+        // Null move: if passing still fails high the position is good
+        // enough to cut. Zugzwang makes this unsound without pieces, and
+        // deep cutoffs are verified by a reduced search without null moves.
+        if (features.nullMove && depth >= 3 && ply >= nullMoveMinPly && staticEval >= beta
+            && hasNonPawnMaterial(state, state.sideToMove)) {
+            int r = 3 + depth / 6;
+            Undo undo = state.makeNullMove();
+            keys.push(state.key);
+            int score = -negamax(-beta, -beta + 1, depth - 1 - r, ply + 1);
+            keys.pop();
+            state.unmakeNullMove(undo);
+            if (stopped()) return 0;
+            if (score >= beta) {
+                if (score >= ValueTBWinInMaxPly) score = beta;
+                // Only the outermost verification runs; a nested one would
+                // lift its restriction on returning.
+                if (depth < NullMoveVerifyDepth || nullMoveMinPly) return score;
+                nullMoveMinPly = ply + 3 * (depth - r) / 4;
+                int verified = negamax(beta - 1, beta, depth - r, ply);
+                nullMoveMinPly = 0;
+                if (verified >= beta) return score;
+            }
+        }
+    }
+
+    MoveList moves;
+    if (ply == 0) moves = rootMoves;
+    else generate<GenType::Legal>(moves);
+    if (moves.empty())
+        return checked ? -ValueMate + ply : 0;
+
+    // Futility: at the frontier, quiet moves cannot lift a hopeless static
+    // score to alpha unless they give check.
+    bool futile = features.futility && !pvNode && !checked && depth <= 3
+        && staticEval + FutilityBase + FutilityMargin * depth <= alpha && std::abs(alpha) < ValueTBWinInMaxPly;
+
+    ScoredMoveList scored;
+    for (const Move& m : moves) scored.add(m, scoreMove(m, ply, ttMove));
+
+    int bestScore = -ValueInfinite;
+    Move bestMove = NoMove;
+    for (int i = 0; i < scored.size(); ++i) {
+        Move m = scored.pickNext(i);
+        bool quiet = !isNoisy(m);
+        int moveHistory = history[colorIndex(state.sideToMove)][m.from()][m.to()];
+        Undo undo = makeMove(m);
+        bool givesCheck = inCheck(state);
+        if (futile && quiet && !givesCheck && i > 0) {
+            unmakeMove(undo);
+            continue;
+        }
+        tt.prefetch(state.key);
+        keys.push(state.key);
+        int score;
+        // Principal variation search: later moves are first tried with a null
+        // window and only re-searched when they might raise alpha. Late quiet
+        // moves are searched reduced first, less so with good history.
+        if (i == 0) {
+            score = -negamax(-beta, -alpha, depth - 1, ply + 1);
+        }
+        else {
+            int r = 0;
+            if (features.lateMoveReductions && depth >= 3 && i >= (pvNode ? 4 : 2) && quiet && !checked
+                && !givesCheck && m != killers[ply][0] && m != killers[ply][1]) {
+                r = Reductions(depth, i) - (pvNode ? 1 : 0) - std::min(2, moveHistory / HistoryReductionScale);
+                r = std::clamp(r, 0, depth - 2);
+            }
+            score = -negamax(-alpha - 1, -alpha, depth - 1 - r, ply + 1);
+            if (r > 0 && score > alpha)
+                score = -negamax(-alpha - 1, -alpha, depth - 1, ply + 1);
+            if (score > alpha && score < beta)
+                score = -negamax(-beta, -alpha, depth - 1, ply + 1);
+        }
+        keys.pop();
+        unmakeMove(undo);
+        if (stopped()) return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = m;
+            if (score > alpha) {
+                alpha = score;
+                pvTable[ply][0] = m;
+                std::copy(pvTable[ply + 1], pvTable[ply + 1] + pvLength[ply + 1], pvTable[ply] + 1);
+                pvLength[ply] = pvLength[ply + 1] + 1;
+                if (alpha >= beta) {
+                    countStat(stats.betaCutoffs);
+                    if (i == 0) countStat(stats.firstMoveCutoffs);
+                    if (!isNoisy(m)) updateQuietStats(m, depth, ply);
+                    break;
+                }
+            }
+        }
+    }
+
+    Bound bound = bestScore >= beta ? BoundLower : bestScore > originalAlpha ? BoundExact : BoundUpper;
+    tt.store(state.key, bestMove, scoreToTT(bestScore, ply), depth, bound);
+    return bestScore;
+}
+
+int Search::quiescence(int alpha, int beta, int ply) {
+    pvLength[ply] = 0;
+    countNode();
+    countStat(stats.qnodes);
+    if (shouldStop()) return 0;
+    // Checked before evasions too, so no line can reach the ply limit.
+    if (ply >= MaxPly - 1) return evaluate();
+
+    bool checked = inCheck(state);
+    int bestScore = -ValueInfinite;
+    if (!checked) {
+        bestScore = evaluate();
+        if (bestScore >= beta) return bestScore;
+        alpha = std::max(alpha, bestScore);
+    }
+
+    // In check every evasion is searched; otherwise only captures and queen
+    // promotions are generated at all.
+    MoveList moves;
+    if (checked) generate<GenType::Evasions>(moves);
+    else generate<GenType::Captures>(moves);
+    if (checked && moves.empty()) return -ValueMate + ply;
+
+    ScoredMoveList noisy;
+    for (const Move& m : moves) noisy.add(m, scoreMove(m, ply, NoMove));
+
+    for (int i = 0; i < noisy.size(); ++i) {
+        Move m = noisy.pickNext(i);
+        Undo undo = makeMove(m);
+        int score = -quiescence(-beta, -alpha, ply + 1);
+        unmakeMove(undo);
+        if (stopped()) return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+                pvTable[ply][0] = m;
+                std::copy(pvTable[ply + 1], pvTable[ply + 1] + pvLength[ply + 1], pvTable[ply] + 1);
+                pvLength[ply] = pvLength[ply + 1] + 1;
+                if (alpha >= beta) {
+                    countStat(stats.betaCutoffs);
+                    if (i == 0) countStat(stats.firstMoveCutoffs);
+                    break;
+                }
+            }
+        }
+    }
+    return bestScore;
+}
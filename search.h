@@ -0,0 +1,188 @@
+#pragma once
+
+#include "boardstate.h"
+#include "evaluate.h"
+#include "keyhistory.h"
+#include "movegen.h"
+#include "searchstats.h"
+#include "timeman.h"
+#include "tt.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+constexpr int MaxPly = 128;
+constexpr int ValueInfinite = 32001;
+constexpr int ValueMate = 32000;
+constexpr int ValueMateInMaxPly = ValueMate - MaxPly;
+// Tablebase wins rank below every mate the search itself has found.
+constexpr int ValueTBWin = ValueMateInMaxPly - MaxPly - 1;
+// Lowest tablebase win, found at the ply limit; everything from here up is a
+// proven result.
+constexpr int ValueTBWinInMaxPly = ValueTBWin - MaxPly;
+// Reserved per move on the clock for communication lag.
+constexpr int64_t DefaultMoveOverheadMs = 10;
+
+// Zero means "no limit" for every field. The clock of the side to move is
+// only consulted when movetimeMs is zero; movesToGo is zero for sudden death.
+struct SearchLimits {
+    int depth = 0;
+    int64_t movetimeMs = 0;
+    uint64_t nodes = 0;
+    int64_t timeMs = 0;
+    int64_t incrementMs = 0;
+    int movesToGo = 0;
+    int64_t overheadMs = DefaultMoveOverheadMs;
+    // Search the predicted position without a clock: the time limits start
+    // counting at ponderhit. A search that ends before then is held by the
+    // caller until the opponent moves.
+    bool ponder = false;
+};
+
+// Selective search features, all on by default. Each can be switched off
+// to measure what it is worth with the bench command.
+struct SearchFeatures {
+    bool nullMove = true;
+    bool lateMoveReductions = true;
+    bool futility = true;
+    bool reverseFutility = true;
+    bool razoring = true;
+    bool checkExtensions = true;
+    bool aspirationWindows = true;
+
+    struct Toggle {
+        const char* name;   // as used for the UCI option and --disable
+        bool SearchFeatures::*flag;
+    };
+    static const Toggle Toggles[7];
+
+    // False if no feature has that name.
+    bool set(const std::string& name, bool enabled);
+};
+
+struct SearchInfo {
+    int depth;
+    int score;
+    uint64_t nodes;
+    int64_t timeMs;
+    std::vector<Move> pv;
+};
+
+struct SearchResult {
+    Move bestMove = NoMove;
+    int score = 0;
+    int depth = 0;
+    uint64_t nodes = 0;
+    int64_t timeMs = 0;
+    std::vector<Move> pv;
+    SearchStats stats;
+};
+
+// Iterative-deepening negamax alpha-beta (principal variation search) with
+// quiescence search. The transposition-table move is tried first, captures
+// are ordered MVV-LVA and quiet moves by killer and history heuristics.
+// Aspiration windows, null-move and futility pruning, razoring, late move
+// reductions and check extensions make the search selective.
+class Search {
+public:
+    Search(Evaluator& evaluator, TranspositionTable& tt) : evaluator(evaluator), tt(tt) { clearHistory(); }
+
+    void setFeatures(const SearchFeatures& f) { features = f; }
+    const SearchFeatures& searchFeatures() const { return features; }
+
+    // History persists from one search to the next, halved each time, so the
+    // move ordering learnt on the previous move stays warm; forget it when a
+    // new game or an unrelated position starts.
+    void clearHistory();
+
+    // Stand-alone search: resets the stop and ponder flags and ages the
+    // table first.
+    // gameKeys holds the keys of the game so far, for repetition detection.
+    SearchResult think(const BoardState& root, const SearchLimits& limits, const KeyHistory* gameKeys = nullptr);
+    // One thread's share of a pooled search. Only thread 0 enforces the
+    // limits and runs the time manager; helpers run until the shared stop flag is raised, and odd
+    // helpers search one ply deeper to spread the threads over the tree.
+    SearchResult run(const BoardState& root, const SearchLimits& limits, int threadId,
+                     const KeyHistory* gameKeys = nullptr);
+
+    void stop() { stopFlag->store(true, std::memory_order_relaxed); }
+    void setStopFlag(std::atomic<bool>* flag) { stopFlag = flag ? flag : &ownStop; }
+    // Lowered by ponderhit; shared by a pool like the stop flag.
+    void ponderhit() { ponderFlag->store(false, std::memory_order_relaxed); }
+    void setPonderFlag(std::atomic<bool>* flag) { ponderFlag = flag ? flag : &ownPonder; }
+    uint64_t nodesSearched() const { return nodes.load(std::memory_order_relaxed); }
+
+    // Called after every completed iteration.
+    std::function<void(const SearchInfo&)> onIteration;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    int negamax(int alpha, int beta, int depth, int ply);
+    int quiescence(int alpha, int beta, int ply);
+    int scoreMove(Move m, int ply, Move ttMove) const;
+    // Instrumented wrappers for the phases SearchStats can time.
+    template <GenType Type>
+    void generate(MoveList& moves) {
+        PhaseTimer timer(stats, SearchPhase::MoveGen);
+        generateMoves<Type>(state, moves);
+        countStat(stats.movesGenerated, moves.size());
+    }
+    int evaluate() {
+        countStat(stats.evalCalls);
+        PhaseTimer timer(stats, SearchPhase::Evaluation);
+        return evaluator.evaluate(state);
+    }
+    Undo makeMove(Move m) {
+        countStat(stats.movesSearched);
+        PhaseTimer timer(stats, SearchPhase::MakeUnmake);
+        return state.makeMove(m);
+    }
+    void unmakeMove(const Undo& undo) {
+        PhaseTimer timer(stats, SearchPhase::MakeUnmake);
+        state.unmakeMove(undo);
+    }
+    void updateQuietStats(Move m, int depth, int ply);
+    bool shouldStop();
+    bool stopped() const { return stopFlag->load(std::memory_order_relaxed); }
+    // True until ponderhit arrives; restarts the clock when it does.
+    bool awaitingPonderhit();
+    void countNode() { nodes.store(nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+    int64_t elapsedMs() const;
+    // Time on our own clock: since ponderhit when pondering.
+    int64_t clockElapsedMs() const;
+
+    Evaluator& evaluator;
+    TranspositionTable& tt;
+    BoardState state;
+    KeyHistory keys;
+    SearchLimits limits;
+    TimeManager time;
+    Clock::time_point startTime;
+    Clock::time_point clockStart;
+    std::atomic<bool> ownStop{ false };
+    std::atomic<bool>* stopFlag = &ownStop;
+    std::atomic<bool> ownPonder{ false };
+    std::atomic<bool>* ponderFlag = &ownPonder;
+    bool pondering = false;
+    // Written only by the searching thread; atomic so the pool can read it.
+    std::atomic<uint64_t> nodes{ 0 };
+    int threadId = 0;
+    SearchStats stats;
+    SearchFeatures features;
+    int rootDepth = 0;
+    // Legal root moves, narrowed by the tablebases when they cover the root.
+    MoveList rootMoves;
+    // Null moves are not tried above this ply while a null-move cutoff is
+    // being verified.
+    int nullMoveMinPly = 0;
+
+    Move killers[MaxPly][2];
+    int history[2][64][64];
+    Move pvTable[MaxPly][MaxPly];
+    int pvLength[MaxPly];
+};
@@ -0,0 +1,53 @@
+#include "searchstats.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+double ratio(uint64_t part, uint64_t whole) { return whole ? 100.0 * part / whole : 0.0; }
+
+} // namespace
+
+SearchStats& SearchStats::operator+=(const SearchStats& s) {
+    nodes += s.nodes;
+    qnodes += s.qnodes;
+    movesGenerated += s.movesGenerated;
+    movesSearched += s.movesSearched;
+    ttProbes += s.ttProbes;
+    ttHits += s.ttHits;
+    ttCutoffs += s.ttCutoffs;
+    betaCutoffs += s.betaCutoffs;
+    firstMoveCutoffs += s.firstMoveCutoffs;
+    evalCalls += s.evalCalls;
+    pawnProbes += s.pawnProbes;
+    pawnHits += s.pawnHits;
+    for (int i = 0; i < PhaseCount; ++i) {
+        cycles[i] += s.cycles[i];
+        timedCalls[i] += s.timedCalls[i];
+    }
+    return *this;
+}
+
+std::string SearchStats::describe() const {
+    if (!Enabled) return "stats disabled";
+    char buf[512];
+    int n = std::snprintf(buf, sizeof(buf),
+        "nodes %llu qnodes %llu (%.1f%%) generated %llu searched %llu ttprobes %llu tthits %.1f%% ttcuts %llu "
+        "cutoffs %llu firstcut %.1f%% evals %llu pawnhits %.1f%%",
+        static_cast<unsigned long long>(nodes), static_cast<unsigned long long>(qnodes), ratio(qnodes, nodes),
+        static_cast<unsigned long long>(movesGenerated), static_cast<unsigned long long>(movesSearched),
+        static_cast<unsigned long long>(ttProbes), ratio(ttHits, ttProbes), static_cast<unsigned long long>(ttCutoffs),
+        static_cast<unsigned long long>(betaCutoffs), ratio(firstMoveCutoffs, betaCutoffs),
+        static_cast<unsigned long long>(evalCalls), ratio(pawnHits, pawnProbes));
+    std::string out(buf, n > 0 ? std::min<size_t>(n, sizeof(buf) - 1) : 0);
+    if (TimingEnabled) {
+        static const char* names[PhaseCount] = { "movegen", "eval", "makeunmake" };
+        for (int i = 0; i < PhaseCount; ++i) {
+            n = std::snprintf(buf, sizeof(buf), " %s %.1f cycles/call", names[i],
+                              timedCalls[i] ? static_cast<double>(cycles[i]) / timedCalls[i] : 0.0);
+            out.append(buf, n > 0 ? n : 0);
+        }
+    }
+    return out;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Build switches: SEARCH_STATS=0 compiles the counters out of the search,
+// SEARCH_TIMING=1 adds cycle timers around the expensive phases.
+#ifndef SEARCH_STATS
+#define SEARCH_STATS 1
+#endif
+#ifndef SEARCH_TIMING
+#define SEARCH_TIMING 0
+#endif
+
+enum class SearchPhase : uint8_t { MoveGen, Evaluation, MakeUnmake, Count };
+
+// Per-thread hot-path counters. Each Search owns one and only its thread
+// writes it, so counting is a plain increment; totals are summed once the
+// threads have finished.
+struct SearchStats {
+    static constexpr bool Enabled = SEARCH_STATS != 0;
+    static constexpr bool TimingEnabled = Enabled && SEARCH_TIMING != 0;
+    static constexpr int PhaseCount = static_cast<int>(SearchPhase::Count);
+
+    uint64_t nodes = 0;              // main search and quiescence together
+    uint64_t qnodes = 0;
+    uint64_t movesGenerated = 0;
+    uint64_t movesSearched = 0;
+    uint64_t ttProbes = 0;
+    uint64_t ttHits = 0;
+    uint64_t ttCutoffs = 0;
+    uint64_t betaCutoffs = 0;
+    uint64_t firstMoveCutoffs = 0;   // beta cutoffs on the first move tried
+    uint64_t evalCalls = 0;
+    uint64_t pawnProbes = 0;
+    uint64_t pawnHits = 0;
+    uint64_t cycles[PhaseCount] = {};
+    uint64_t timedCalls[PhaseCount] = {};
+
+    SearchStats& operator+=(const SearchStats& s);
+    // One line of "name value" pairs, with ratios, for dumps and UCI info.
+    std::string describe() const;
+};
+
+inline void countStat(uint64_t& counter, uint64_t n = 1) {
+    if constexpr (SearchStats::Enabled) counter += n;
+}
+
+inline uint64_t readCycleCounter() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// Adds the cycles spent in its scope to one phase. Without SEARCH_TIMING it
+// does nothing and is optimised away.
+class PhaseTimer {
+public:
+    PhaseTimer(SearchStats& stats, SearchPhase phase) : stats(stats), phase(static_cast<int>(phase)) {
+        if constexpr (SearchStats::TimingEnabled) start = readCycleCounter();
+    }
+    ~PhaseTimer() {
+        if constexpr (SearchStats::TimingEnabled) {
+            stats.cycles[phase] += readCycleCounter() - start;
+            ++stats.timedCalls[phase];
+        }
+    }
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    SearchStats& stats;
+    int phase;
+    uint64_t start = 0;
+};
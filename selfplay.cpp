@@ -0,0 +1,267 @@
+#include "selfplay.h"
+
+#include "fen.h"
+#include "keyhistory.h"
+#include "movegen.h"
+#include "nnue.h"
+#include "pgn.h"
+#include "search.h"
+#include "trainingdata.h"
+#include "tt.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class GameEnd { Checkmate, Stalemate, Repetition, FiftyMoves, Material, MaxPlies, Time };
+
+const char* endName(GameEnd e) {
+    static const char* names[] = { "checkmate", "stalemate", "repetition", "fifty moves",
+                                   "insufficient material", "move limit", "time forfeit" };
+    return names[static_cast<int>(e)];
+}
+
+struct GameRecord {
+    double whiteScore;
+    GameEnd end;
+    int plies;
+};
+
+// One player, owned by a single worker for the whole match.
+struct Engine {
+    Engine(const Evaluator& prototype, size_t hashMB)
+        : evaluator(prototype.clone()), tt(hashMB), search(*evaluator, tt) {}
+
+    std::unique_ptr<Evaluator> evaluator;
+    TranspositionTable tt;
+    Search search;
+};
+
+// Per-worker task deque: the owner takes from the back and idle workers
+// steal from the front, so contention only arises near the end of a match.
+class TaskQueue {
+public:
+    void push(int task) {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(task);
+    }
+    bool pop(int& task) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tasks.empty()) return false;
+        task = tasks.back();
+        tasks.pop_back();
+        return true;
+    }
+    bool steal(int& task) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tasks.empty()) return false;
+        task = tasks.front();
+        tasks.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex mutex;
+    std::deque<int> tasks;
+};
+
+// Lone kings, or a single minor piece against a bare king.
+bool insufficientMaterial(const BoardState& state) {
+    if (state.typeBB(PieceType::Pawn) | state.typeBB(PieceType::Rook) | state.typeBB(PieceType::Queen)) return false;
+    return popCount(state.typeBB(PieceType::Bishop) | state.typeBB(PieceType::Knight)) <= 1;
+}
+
+struct PlayedMove {
+    Move move;
+    int score;   // search score, from the mover's point of view
+};
+
+// The moves played are left in moves, for the PGN and training-data logs.
+GameRecord playGame(BoardState position, Engine* players[2], const MatchOptions& options,
+                    std::vector<PlayedMove>& moves) {
+    moves.clear();
+    for (int i = 0; i < 2; ++i) {
+        players[i]->tt.clear();
+        players[i]->search.clearHistory();
+    }
+    KeyHistory keys;
+    keys.push(position.key);
+    int64_t clock[2] = { options.baseMs, options.baseMs };
+
+    for (int ply = 0;; ++ply) {
+        PieceColor us = position.sideToMove;
+        double usScore = us == PieceColor::White ? 1.0 : 0.0;
+        MoveList legal;
+        generateLegalMoves(position, legal);
+        if (legal.empty())
+            return inCheck(position) ? GameRecord{ 1.0 - usScore, GameEnd::Checkmate, ply } : GameRecord{ 0.5, GameEnd::Stalemate, ply };
+        if (position.halfmoveClock >= 100) return { 0.5, GameEnd::FiftyMoves, ply };
+        if (keys.repetitions(position.halfmoveClock) >= 2) return { 0.5, GameEnd::Repetition, ply };
+        if (insufficientMaterial(position)) return { 0.5, GameEnd::Material, ply };
+        if (ply >= options.maxPlies) return { 0.5, GameEnd::MaxPlies, ply };
+
+        int side = colorIndex(us);
+        SearchLimits limits;
+        limits.timeMs = std::max<int64_t>(1, clock[side]);   // zero would mean no limit
+        limits.incrementMs = options.incrementMs;
+        Clock::time_point start = Clock::now();
+        SearchResult result = players[side]->search.think(position, limits, &keys);
+        clock[side] -= std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+        if (clock[side] < 0) return { 1.0 - usScore, GameEnd::Time, ply };
+        clock[side] += options.incrementMs;
+
+        position.makeMove(result.bestMove);
+        moves.push_back({ result.bestMove, result.score });
+        keys.push(position.key);
+    }
+}
+
+const char* engineName(const EngineConfig& engine) {
+    return engine.evalFile.empty() ? "chess1 (classical)" : engine.evalFile.c_str();
+}
+
+double eloFromScore(double s) {
+    s = std::fmin(std::fmax(s, 1e-6), 1 - 1e-6);
+    return -400.0 * std::log10(1.0 / s - 1.0);
+}
+
+double scoreFromElo(double elo) { return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0)); }
+
+// Per-game variance of the score.
+double scoreVariance(const MatchStats& m) {
+    int n = m.games();
+    if (!n) return 0;
+    double s = m.score();
+    return (m.wins * (1 - s) * (1 - s) + m.draws * (0.5 - s) * (0.5 - s) + m.losses * s * s) / n;
+}
+
+} // namespace
+
+double MatchStats::elo() const { return eloFromScore(score()); }
+
+double MatchStats::eloError() const {
+    int n = games();
+    if (!n) return 0;
+    double margin = 1.96 * std::sqrt(scoreVariance(*this) / n);
+    return (eloFromScore(score() + margin) - eloFromScore(score() - margin)) / 2;
+}
+
+double MatchStats::llr(double elo0, double elo1) const {
+    double var = scoreVariance(*this);
+    if (var <= 0) return 0;
+    double s0 = scoreFromElo(elo0), s1 = scoreFromElo(elo1);
+    return games() * (s1 - s0) * (2 * score() - s0 - s1) / (2 * var);
+}
+
+bool MatchRunner::run() {
+    openings.clear();
+    if (!options.openingsFile.empty()) {
+        if (!loadFENFile(options.openingsFile.c_str(), openings) || openings.empty()) {
+            std::printf("cannot load openings from %s\n", options.openingsFile.c_str());
+            return false;
+        }
+    }
+    else {
+        openings.emplace_back();
+        openings.back().setStartPosition();
+    }
+
+    std::unique_ptr<Evaluator> prototypes[2];
+    for (int i = 0; i < 2; ++i) prototypes[i] = makeEvaluator(options.engines[i].evalFile);
+
+    int workerCount = std::max(1, std::min(options.concurrency, options.games));
+    std::vector<TaskQueue> queues(workerCount);
+    // Game g plays opening g / 2; odd games swap colours.
+    for (int g = 0; g < options.games; ++g) queues[g % workerCount].push(g);
+
+    const double lower = std::log(options.beta / (1 - options.alpha));
+    const double upper = std::log((1 - options.beta) / options.alpha);
+    totals = MatchStats();
+    std::mutex resultsMutex;
+    std::FILE* pgn = nullptr;
+    if (!options.pgnFile.empty() && !(pgn = std::fopen(options.pgnFile.c_str(), "w")))
+        std::printf("cannot write %s\n", options.pgnFile.c_str());
+    TrainingWriter data;
+    if (!options.dataFile.empty() && !data.open(options.dataFile.c_str()))
+        std::printf("cannot write %s\n", options.dataFile.c_str());
+    std::atomic<bool> decided{ false };
+    Clock::time_point started = Clock::now();
+
+    auto worker = [&](int id) {
+        std::unique_ptr<Engine> engines[2];
+        for (int i = 0; i < 2; ++i) engines[i] = std::make_unique<Engine>(*prototypes[i], options.engines[i].hashMB);
+
+        std::vector<PlayedMove> moves;
+        PgnGame game;
+        int g;
+        while (!decided.load(std::memory_order_relaxed)) {
+            bool found = queues[id].pop(g);
+            for (int k = 1; !found && k < workerCount; ++k) found = queues[(id + k) % workerCount].steal(g);
+            if (!found) break;
+
+            bool firstIsWhite = (g & 1) == 0;
+            Engine* players[2] = { engines[firstIsWhite ? 0 : 1].get(), engines[firstIsWhite ? 1 : 0].get() };
+            const BoardState& opening = openings[(g / 2) % openings.size()];
+            GameRecord record = playGame(opening, players, options, moves);
+            const char* result = record.whiteScore == 1.0 ? "1-0" : record.whiteScore == 0.0 ? "0-1" : "1/2-1/2";
+            double firstScore = firstIsWhite ? record.whiteScore : 1.0 - record.whiteScore;
+
+            std::lock_guard<std::mutex> lock(resultsMutex);
+            if (firstScore == 1.0) ++totals.wins;
+            else if (firstScore == 0.0) ++totals.losses;
+            else ++totals.draws;
+            double llr = totals.llr(options.elo0, options.elo1);
+            std::printf("game %d: %s (%s, %d plies)  +%d =%d -%d  elo %.1f +/- %.1f  llr %.2f\n", g + 1, result,
+                        endName(record.end), record.plies, totals.wins, totals.draws, totals.losses,
+                        totals.elo(), totals.eloError(), llr);
+            std::fflush(stdout);
+            if (pgn) {
+                game.clear();
+                game.tags = { { "Event", "chess1 match" }, { "Round", std::to_string(g + 1) },
+                              { "White", engineName(options.engines[firstIsWhite ? 0 : 1]) },
+                              { "Black", engineName(options.engines[firstIsWhite ? 1 : 0]) },
+                              { "Result", result }, { "Termination", endName(record.end) } };
+                game.start = opening;
+                game.moves.clear();
+                for (const PlayedMove& m : moves) game.moves.push_back(m.move);
+                game.result = result;
+                writePgn(pgn, game);
+            }
+            if (data.isOpen()) {
+                int whiteResult = record.whiteScore == 1.0 ? 1 : record.whiteScore == 0.0 ? -1 : 0;
+                BoardState position = opening;
+                for (const PlayedMove& m : moves) {
+                    data.write(position, m.score, m.move, whiteResult);
+                    position.makeMove(m.move);
+                }
+            }
+            if (llr <= lower || llr >= upper) decided.store(true, std::memory_order_relaxed);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < workerCount; ++i) threads.emplace_back(worker, i);
+    for (std::thread& t : threads) t.join();
+    if (pgn) std::fclose(pgn);
+    if (data.isOpen()) std::printf("%llu training positions written\n", static_cast<unsigned long long>(data.count()));
+    data.close();
+
+    double seconds = std::chrono::duration<double>(Clock::now() - started).count();
+    double llr = totals.llr(options.elo0, options.elo1);
+    std::printf("\ngames %d  +%d =%d -%d  score %.3f  elo %.1f +/- %.1f\n", totals.games(), totals.wins,
+                totals.draws, totals.losses, totals.score(), totals.elo(), totals.eloError());
+    std::printf("sprt [%.1f, %.1f]  llr %.2f  bounds [%.2f, %.2f]  %s\n", options.elo0, options.elo1, llr, lower, upper,
+                llr >= upper ? "H1 accepted" : llr <= lower ? "H0 accepted" : "inconclusive");
+    std::printf("%.1f s  %.0f games/hour\n", seconds, seconds > 0 ? totals.games() * 3600.0 / seconds : 0.0);
+    return true;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "boardstate.h"
+#include "evaluate.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct EngineConfig {
+    std::string evalFile;   // empty for the handcrafted evaluation
+    size_t hashMB = 16;
+};
+
+struct MatchOptions {
+    int games = 100;
+    int concurrency = 1;
+    int64_t baseMs = 10000;
+    int64_t incrementMs = 100;
+    int maxPlies = 400;        // adjudicated as a draw beyond this
+    std::string openingsFile;  // FEN/EPD, one opening per line; empty for the start position
+    EngineConfig engines[2];   // engines[0] is the one being measured
+    std::string pgnFile;       // every finished game is written here when set
+    std::string dataFile;      // training positions with score, move and result
+    // SPRT hypotheses in Elo, with alpha and beta error rates.
+    double elo0 = 0;
+    double elo1 = 5;
+    double alpha = 0.05;
+    double beta = 0.05;
+};
+
+struct MatchStats {
+    int wins = 0;     // from engines[0]'s point of view
+    int draws = 0;
+    int losses = 0;
+
+    int games() const { return wins + draws + losses; }
+    double score() const { return games() ? (wins + 0.5 * draws) / games() : 0.5; }
+    // Logistic Elo difference and the half-width of its 95% interval.
+    double elo() const;
+    double eloError() const;
+    // Log-likelihood ratio of elo1 against elo0 under the trinomial model.
+    double llr(double elo0, double elo1) const;
+};
+
+// Headless engine-versus-engine match. Games are handed out on a
+// work-stealing pool: each worker owns its own engines and only publishes
+// finished results, so games never share search state. Every opening is
+// played twice with colours reversed.
+class MatchRunner {
+public:
+    explicit MatchRunner(const MatchOptions& options) : options(options) {}
+
+    // Plays the match, printing progress and the final statistics; stops
+    // early once the SPRT accepts either hypothesis. False if the openings
+    // cannot be loaded.
+    bool run();
+    const MatchStats& stats() const { return totals; }
+
+private:
+    MatchOptions options;
+    std::vector<BoardState> openings;
+    MatchStats totals;
+};
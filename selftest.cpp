@@ -0,0 +1,124 @@
+#include "selftest.h"
+
+#include "book.h"
+#include "movegen.h"
+#include "tablebase.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+namespace {
+
+struct KeyCase {
+    const char* fen;
+    uint64_t key;
+};
+
+// The examples published with the Polyglot book format.
+constexpr KeyCase PolyglotKeys[] = {
+    { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 0x463b96181691fc9cULL },
+    { "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1", 0x823c9b50fd114196ULL },
+    { "rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 2", 0x0756b94461c50fb0ULL },
+    { "rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR b KQkq - 0 2", 0x662fafb965db29d4ULL },
+    { "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3", 0x22a48b5a8e47ff78ULL },
+    { "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR b kq - 0 3", 0x652a607ca3f242c1ULL },
+    { "rnbq1bnr/ppp1pkpp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR w - - 0 4", 0x00fdd303c946bdd9ULL },
+    { "rnbqkbnr/p1pppppp/8/8/PpP4P/8/1P1PPPP1/RNBQKBNR b KQkq c3 0 3", 0x3c8123ea7b067637ULL },
+    { "rnbqkbnr/p1pppppp/8/8/P6P/R1p5/1P1PPPP1/1NBQKBNR b Kkq - 0 4", 0x5c3f9b829b279560ULL },
+};
+
+bool checkPolyglotKeys() {
+    bool allPassed = true;
+    for (const KeyCase& c : PolyglotKeys) {
+        BoardState state;
+        bool ok = state.setFEN(c.fen);
+        uint64_t key = ok ? OpeningBook::key(state) : 0;
+        ok = ok && key == c.key;
+        allPassed = allPassed && ok;
+        std::printf("polyglot key %016llx  expected %016llx  %s\n", static_cast<unsigned long long>(key),
+                    static_cast<unsigned long long>(c.key), ok ? "ok" : "FAIL");
+    }
+    return allPassed;
+}
+
+struct TablebaseCase {
+    const char* fen;
+    WDLScore wdl;
+    int dtz;
+};
+
+// Results that follow from the position alone: mates, stalemates, forced
+// captures and textbook king and pawn endings.
+constexpr TablebaseCase TablebaseResults[] = {
+    { "R3k3/8/4K3/8/8/8/8/8 b - - 0 1", WDLScore::Loss, 0 },
+    { "4k3/8/4K3/8/8/8/8/R7 w - - 0 1", WDLScore::Win, 1 },
+    { "8/8/8/8/8/2k5/1q6/K7 w - - 0 1", WDLScore::Loss, 0 },
+    { "8/8/8/8/8/8/6Qk/K7 b - - 0 1", WDLScore::Draw, 0 },
+    { "4k3/4P3/4K3/8/8/8/8/8 b - - 0 1", WDLScore::Draw, 0 },
+    { "4k3/4P3/4K3/8/8/8/8/8 w - - 0 1", WDLScore::Win, 5 },
+    { "4k3/8/4K3/8/4P3/8/8/8 w - - 0 1", WDLScore::Win, 1 },
+    { "4k3/8/4K3/8/4P3/8/8/8 b - - 0 1", WDLScore::Loss, -2 },
+    { "k7/8/8/P7/8/8/8/K7 w - - 0 1", WDLScore::Draw, 0 },
+    { "8/8/8/3k4/8/8/8/2BK4 w - - 0 1", WDLScore::Draw, 0 },
+};
+
+bool checkTablebaseResults() {
+    bool allPassed = true;
+    for (const TablebaseCase& c : TablebaseResults) {
+        BoardState state;
+        WDLScore wdl = WDLScore::Draw;
+        int dtz = 0;
+        bool ok = state.setFEN(c.fen) && Tablebases::probeWDL(state, wdl) && Tablebases::probeDTZ(state, dtz)
+                  && wdl == c.wdl && dtz == c.dtz;
+        allPassed = allPassed && ok;
+        std::printf("tablebase wdl %2d dtz %3d  expected %2d %3d  %s  %s\n", static_cast<int>(wdl), dtz,
+                    static_cast<int>(c.wdl), c.dtz, ok ? "ok" : "FAIL", c.fen);
+    }
+    return allPassed;
+}
+
+// Longest win with the strong side to move, over every legal placement.
+int longestWin(PieceType piece) {
+    int longest = 0;
+    for (Square wk = 0; wk < 64; ++wk)
+        for (Square bk = 0; bk < 64; ++bk)
+            for (Square sq = 0; sq < 64; ++sq) {
+                if (wk == bk || sq == wk || sq == bk) continue;
+                BoardState state;
+                state.clear();
+                state.putPiece(PieceColor::White, PieceType::King, wk);
+                state.putPiece(PieceColor::Black, PieceType::King, bk);
+                state.putPiece(PieceColor::White, piece, sq);
+                state.sideToMove = PieceColor::Black;
+                if (inCheck(state)) continue;
+                state.sideToMove = PieceColor::White;
+                int dtz;
+                if (Tablebases::probeDTZ(state, dtz)) longest = std::max(longest, dtz);
+            }
+    return longest;
+}
+
+// Without pawns the only zeroing move is the mate, so the longest distance
+// is the published longest mate: 10 moves with a queen, 16 with a rook.
+bool checkLongestWins() {
+    bool allPassed = true;
+    for (auto [piece, plies] : { std::pair{ PieceType::Queen, 19 }, std::pair{ PieceType::Rook, 31 } }) {
+        int longest = longestWin(piece);
+        bool ok = longest == plies;
+        allPassed = allPassed && ok;
+        std::printf("longest K%cvK win %d plies  expected %d  %s\n", pieceSymbol(makePiece(PieceColor::White, piece)),
+                    longest, plies, ok ? "ok" : "FAIL");
+    }
+    return allPassed;
+}
+
+} // namespace
+
+bool runSelfTest() {
+    bool allPassed = checkPolyglotKeys();
+    allPassed = checkTablebaseResults() && allPassed;
+    allPassed = checkLongestWins() && allPassed;
+    std::printf("\n%s\n", allPassed ? "all passed" : "FAILED");
+    return allPassed;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+// Checks against published reference values that perft cannot cover:
+// Polyglot book keys and endgame tablebase results. Prints one line per
+// check and returns true if every one passed.
+bool runSelfTest();
@@ -0,0 +1,476 @@
+#include "syzygy.h"
+
+#include "bitboard.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr uint8_t WDLMagic[4] = { 0x71, 0xE8, 0x23, 0x5D };
+constexpr uint8_t DTZMagic[4] = { 0xD7, 0x66, 0x0C, 0xA5 };
+
+// Flags of the file header and of each PairsData.
+enum : uint8_t { HasPawnsFlag = 2 };
+enum : uint8_t { StmFlag = 1, MappedFlag = 2, WinPliesFlag = 4, LossPliesFlag = 8, WideFlag = 16, SingleValueFlag = 128 };
+
+constexpr int MaxPieces = SyzygyTable::MaxPieces;
+
+// Multi-byte fields are little-endian except the compressed bit stream.
+uint16_t readLE16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | p[1] << 8); }
+uint32_t readLE32(const uint8_t* p) {
+    return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+}
+uint32_t readBE32(const uint8_t* p) {
+    return uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 | uint32_t(p[3]);
+}
+uint64_t readBE64(const uint8_t* p) { return uint64_t(readBE32(p)) << 32 | readBE32(p + 4); }
+
+// Piece codes of the file format: pawn 1 up to king 6, black adds 8.
+int pieceCode(PieceColor c, PieceType t) { return (6 - typeIndex(t)) | (c == PieceColor::Black ? 8 : 0); }
+
+// Distance of a square above (positive) or below the a1-h8 diagonal.
+int offDiagonal(Square sq) { return rankOf(sq) - fileOf(sq); }
+Square flipFile(Square sq) { return sq ^ 7; }
+Square flipRank(Square sq) { return sq ^ 56; }
+
+// Square numberings and binomials the table indices are built from.
+struct Encoding {
+    int mapB1H1H7[64] = {};
+    int mapA1D1D4[64] = {};
+    int mapKK[10][64] = {};
+    int mapPawns[64] = {};
+    uint64_t binomial[MaxPieces][64] = {};
+    uint64_t leadPawnIdx[MaxPieces][64] = {};
+    uint64_t leadPawnsSize[MaxPieces][4] = {};
+
+    Encoding() {
+        int code = 0;
+        for (Square s = 0; s < 64; ++s)
+            if (offDiagonal(s) < 0) mapB1H1H7[s] = code++;
+
+        // The a1-d1-d4 triangle, its diagonal numbered last.
+        std::vector<Square> diagonal;
+        code = 0;
+        for (Square s = 0; s <= 27; ++s) {
+            if (fileOf(s) > 3) continue;
+            if (offDiagonal(s) < 0) mapA1D1D4[s] = code++;
+            else if (!offDiagonal(s)) diagonal.push_back(s);
+        }
+        for (Square s : diagonal) mapA1D1D4[s] = code++;
+
+        // Both kings of a pawnless table: the first in the triangle, the
+        // second legally placed and, with the first on the diagonal, not
+        // above it. Pairs with both on the diagonal come last.
+        std::vector<std::pair<int, Square>> bothOnDiagonal;
+        code = 0;
+        for (int idx = 0; idx < 10; ++idx)
+            for (Square s1 = 0; s1 <= 27; ++s1) {
+                if (mapA1D1D4[s1] != idx || (!idx && s1 != 1)) continue;
+                for (Square s2 = 0; s2 < 64; ++s2) {
+                    if ((kingAttacks(s1) | squareBB(s1)) & squareBB(s2)) continue;
+                    if (!offDiagonal(s1) && offDiagonal(s2) > 0) continue;
+                    if (!offDiagonal(s1) && !offDiagonal(s2)) bothOnDiagonal.emplace_back(idx, s2);
+                    else mapKK[idx][s2] = code++;
+                }
+            }
+        for (const auto& p : bothOnDiagonal) mapKK[p.first][p.second] = code++;
+
+        binomial[0][0] = 1;
+        for (int n = 1; n < 64; ++n)
+            for (int k = 0; k < MaxPieces && k <= n; ++k)
+                binomial[k][n] = (k > 0 ? binomial[k - 1][n - 1] : 0) + (k < n ? binomial[k][n - 1] : 0);
+
+        // Leading pawns, files a-d; a square and its mirror are numbered
+        // together, from the second rank up.
+        int available = 47;
+        for (int count = 1; count < MaxPieces; ++count)
+            for (int f = 0; f < 4; ++f) {
+                uint64_t idx = 0;
+                for (int r = 1; r <= 6; ++r) {
+                    Square sq = makeSquare(f, r);
+                    if (count == 1) {
+                        mapPawns[sq] = available--;
+                        mapPawns[flipFile(sq)] = available--;
+                    }
+                    leadPawnIdx[count][sq] = idx;
+                    idx += binomial[count - 1][mapPawns[sq]];
+                }
+                leadPawnsSize[count][f] = idx;
+            }
+    }
+};
+
+const Encoding& encoding() {
+    static const Encoding e;
+    return e;
+}
+
+} // namespace
+
+SyzygyTable::SyzygyTable(Kind kind, std::string path, const int (&counts)[2][6])
+    : kind(kind), path(std::move(path)) {
+    const int pawn = typeIndex(PieceType::Pawn);
+    symmetric = true;
+    for (int t = 0; t < 6; ++t) {
+        pieceCount += counts[0][t] + counts[1][t];
+        symmetric &= counts[0][t] == counts[1][t];
+        if (t != typeIndex(PieceType::King)) hasUniquePieces |= counts[0][t] == 1 || counts[1][t] == 1;
+    }
+    hasPawns = counts[0][pawn] || counts[1][pawn];
+    // The leading pawns are White's unless only Black has pawns or Black
+    // has fewer.
+    bool whiteLeads = !counts[1][pawn] || (counts[0][pawn] && counts[1][pawn] >= counts[0][pawn]);
+    pawnCount[0] = counts[whiteLeads ? 0 : 1][pawn];
+    pawnCount[1] = counts[whiteLeads ? 1 : 0][pawn];
+    sides = kind == Kind::WDL && !symmetric ? 2 : 1;
+}
+
+bool SyzygyTable::load() {
+    std::call_once(once, [&] {
+        const uint8_t* magic = kind == Kind::WDL ? WDLMagic : DTZMagic;
+        valid = pieceCount <= MaxPieces && file.open(path.c_str()) && file.size() > 5
+                && std::memcmp(file.data(), magic, 4) == 0 && parse(file.data() + 4, file.data() + file.size());
+        if (!valid) file.close();
+    });
+    return valid;
+}
+
+// Layout after the magic: a flag byte, the piece order of every file, then
+// the PairsData headers, the DTZ value maps, the sparse indices, the block
+// lengths and the 64-byte aligned compressed blocks. Word and block
+// alignment is by address, which the page-aligned mapping keeps equal to
+// the file offset.
+bool SyzygyTable::parse(const uint8_t* data, const uint8_t* end) {
+    if (!(*data & HasPawnsFlag) != !hasPawns) return false;
+    ++data;
+    const int files = hasPawns ? 4 : 1;
+    const bool pp = hasPawns && pawnCount[1];
+    for (int f = 0; f < files; ++f) {
+        if (end - data < 1 + pp + pieceCount) return false;
+        int order[2][2] = { { data[0] & 0xF, pp ? data[1] & 0xF : 0xF }, { data[0] >> 4, pp ? data[1] >> 4 : 0xF } };
+        data += 1 + pp;
+        for (int k = 0; k < pieceCount; ++k, ++data)
+            for (int i = 0; i < sides; ++i) items[i][f].pieces[k] = i ? *data >> 4 : *data & 0xF;
+        for (int i = 0; i < sides; ++i) setGroups(items[i][f], order[i], f);
+    }
+    data += reinterpret_cast<uintptr_t>(data) & 1;
+
+    for (int f = 0; f < files; ++f)
+        for (int i = 0; i < sides; ++i)
+            if (!(data = setSizes(items[i][f], data, end))) return false;
+    if (kind == Kind::DTZ && (data = setDTZMap(data, files)) > end) return false;
+    for (int f = 0; f < files; ++f)
+        for (int i = 0; i < sides; ++i) {
+            items[i][f].sparseIndex = data;
+            data += items[i][f].sparseIndexSize * 6;
+        }
+    for (int f = 0; f < files; ++f)
+        for (int i = 0; i < sides; ++i) {
+            items[i][f].blockLength = data;
+            data += uint64_t(items[i][f].blockLengthSize) * 2;
+        }
+    for (int f = 0; f < files; ++f)
+        for (int i = 0; i < sides; ++i) {
+            data += (64 - (reinterpret_cast<uintptr_t>(data) & 63)) & 63;
+            items[i][f].data = data;
+            data += items[i][f].numBlocks * items[i][f].blockSize;
+        }
+    return data <= end;
+}
+
+// Groups are runs of like pieces indexed together; the leading group holds
+// the leading pawns, or two or three pieces fixed by the symmetries. The
+// per-file order says in which sequence the groups multiply into the index.
+void SyzygyTable::setGroups(PairsData& d, const int (&order)[2], int file) {
+    const Encoding& e = encoding();
+    int n = 0, firstLen = hasPawns ? 0 : hasUniquePieces ? 3 : 2;
+    d.groupLen[n] = 1;
+    for (int i = 1; i < pieceCount; ++i)
+        if (--firstLen > 0 || d.pieces[i] == d.pieces[i - 1]) ++d.groupLen[n];
+        else d.groupLen[++n] = 1;
+    d.groupLen[++n] = 0;
+
+    const bool pp = hasPawns && pawnCount[1];
+    int next = pp ? 2 : 1;
+    int freeSquares = 64 - d.groupLen[0] - (pp ? d.groupLen[1] : 0);
+    uint64_t idx = 1;
+    for (int k = 0; next < n || k == order[0] || k == order[1]; ++k) {
+        if (k == order[0]) {
+            d.groupIdx[0] = idx;
+            idx *= hasPawns ? e.leadPawnsSize[d.groupLen[0]][file] : hasUniquePieces ? 31332 : 462;
+        }
+        else if (k == order[1]) {
+            d.groupIdx[1] = idx;
+            idx *= e.binomial[d.groupLen[1]][48 - d.groupLen[0]];
+        }
+        else {
+            d.groupIdx[next] = idx;
+            idx *= e.binomial[d.groupLen[next]][freeSquares];
+            freeSquares -= d.groupLen[next++];
+        }
+    }
+    d.groupIdx[n] = idx;
+}
+
+const uint8_t* SyzygyTable::setSizes(PairsData& d, const uint8_t* data, const uint8_t* end) {
+    if (end - data < 2) return nullptr;
+    d.flags = *data++;
+    if (d.flags & SingleValueFlag) {
+        d.minSymLen = *data++;
+        return data;
+    }
+    if (end - data < 10) return nullptr;
+    uint64_t size = d.groupIdx[std::find(d.groupLen, d.groupLen + MaxPieces, 0) - d.groupLen];
+    d.blockSize = uint64_t(1) << data[0];
+    d.span = uint64_t(1) << data[1];
+    d.sparseIndexSize = (size + d.span - 1) / d.span;
+    int padding = data[2];
+    d.numBlocks = readLE32(data + 3);
+    d.blockLengthSize = d.numBlocks + padding;
+    d.maxSymLen = data[7];
+    d.minSymLen = data[8];
+    data += 9;
+    if (d.maxSymLen < d.minSymLen || d.maxSymLen + d.minSymLen > 64) return nullptr;
+
+    // Canonical Huffman codes: base64[i] is the smallest left-aligned code
+    // of length minSymLen + i, lowestSym[i] the symbol it stands for.
+    d.lowestSym = data;
+    d.base64.assign(d.maxSymLen - d.minSymLen + 1, 0);
+    data += d.base64.size() * 2;
+    if (end - data < 2) return nullptr;
+    for (int i = static_cast<int>(d.base64.size()) - 2; i >= 0; --i)
+        d.base64[i] = (d.base64[i + 1] + readLE16(d.lowestSym + 2 * i) - readLE16(d.lowestSym + 2 * (i + 1))) / 2;
+    for (size_t i = 0; i < d.base64.size(); ++i) d.base64[i] <<= 64 - i - d.minSymLen;
+
+    // Every symbol is a value (right child 0xFFF) or a pair of symbols;
+    // symlen counts the values a symbol expands to, less one.
+    size_t symbols = readLE16(data);
+    data += 2;
+    d.btree = data;
+    data += symbols * 3 + (symbols & 1);
+    if (data > end) return nullptr;
+    d.symlen.assign(symbols, 0);
+    std::vector<uint8_t> visited(symbols, 0);
+    bool ok = true;
+    auto expand = [&](auto& self, size_t s) -> void {
+        visited[s] = 1;
+        const uint8_t* lr = d.btree + 3 * s;
+        size_t left = (lr[1] & 0xF) << 8 | lr[0], right = lr[2] << 4 | lr[1] >> 4;
+        if (right == 0xFFF) return;
+        if (left >= symbols || right >= symbols) {
+            ok = false;
+            return;
+        }
+        if (!visited[left]) self(self, left);
+        if (!visited[right]) self(self, right);
+        d.symlen[s] = static_cast<uint8_t>(d.symlen[left] + d.symlen[right] + 1);
+    };
+    for (size_t s = 0; s < symbols && ok; ++s)
+        if (!visited[s]) expand(expand, s);
+    return ok ? data : nullptr;
+}
+
+// DTZ values are stored as indices into small per-file maps for each of
+// the four decisive results, when that compresses better.
+const uint8_t* SyzygyTable::setDTZMap(const uint8_t* data, int files) {
+    dtzMap = data;
+    for (int f = 0; f < files; ++f) {
+        PairsData& d = items[0][f];
+        if (!(d.flags & MappedFlag)) continue;
+        if (d.flags & WideFlag) {
+            data += reinterpret_cast<uintptr_t>(data) & 1;
+            for (int i = 0; i < 4; ++i) {
+                d.mapIdx[i] = static_cast<uint16_t>((data - dtzMap) / 2 + 1);
+                data += 2 + 2 * readLE16(data);
+            }
+        }
+        else {
+            for (int i = 0; i < 4; ++i) {
+                d.mapIdx[i] = static_cast<uint16_t>(data - dtzMap + 1);
+                data += 1 + *data;
+            }
+        }
+    }
+    return data + (reinterpret_cast<uintptr_t>(data) & 1);
+}
+
+SyzygyTable::PairsData* SyzygyTable::encode(const BoardState& state, bool flipped, uint64_t& index, int& tbFile) {
+    const Encoding& e = encoding();
+    Square squares[MaxPieces];
+    int pieces[MaxPieces];
+    int size = 0, leadPawnsCount = 0;
+    Bitboard leadPawns = 0;
+    tbFile = 0;
+
+    // Tables store the named material with White as the stronger side, and
+    // a symmetric one with White to move; anything else is mirrored.
+    bool flip = flipped || (symmetric && state.sideToMove == PieceColor::Black);
+    int flipColor = flip ? 8 : 0, flipSquares = flip ? 56 : 0;
+    int stm = flip ^ (state.sideToMove == PieceColor::Black);
+
+    auto byPawnMap = [&](Square a, Square b) { return e.mapPawns[a] < e.mapPawns[b]; };
+    if (hasPawns) {
+        PieceColor leader = (items[0][0].pieces[0] ^ flipColor) & 8 ? PieceColor::Black : PieceColor::White;
+        leadPawns = state.bb(leader, PieceType::Pawn);
+        for (Bitboard b = leadPawns; b;) squares[size++] = popLsb(b) ^ flipSquares;
+        leadPawnsCount = size;
+        std::swap(squares[0], *std::max_element(squares, squares + size, byPawnMap));
+        tbFile = std::min(fileOf(squares[0]), 7 - fileOf(squares[0]));
+    }
+
+    // A DTZ file holds one side to move only.
+    if (kind == Kind::DTZ && (items[0][tbFile].flags & StmFlag) != stm && !(symmetric && !hasPawns)) return nullptr;
+
+    for (Bitboard b = state.occupied ^ leadPawns; b;) {
+        Square sq = popLsb(b);
+        squares[size] = sq ^ flipSquares;
+        pieces[size++] = pieceCode(state.colorAt(sq), state.typeAt(sq)) ^ flipColor;
+    }
+
+    // Put the pieces in the order the table lists them.
+    PairsData* d = &items[stm % sides][tbFile];
+    for (int i = leadPawnsCount; i < size - 1; ++i)
+        for (int j = i + 1; j < size; ++j)
+            if (d->pieces[i] == pieces[j]) {
+                std::swap(pieces[i], pieces[j]);
+                std::swap(squares[i], squares[j]);
+                break;
+            }
+
+    if (fileOf(squares[0]) > 3)
+        for (int i = 0; i < size; ++i) squares[i] = flipFile(squares[i]);
+
+    uint64_t idx;
+    if (hasPawns) {
+        idx = e.leadPawnIdx[leadPawnsCount][squares[0]];
+        std::stable_sort(squares + 1, squares + leadPawnsCount, byPawnMap);
+        for (int i = 1; i < leadPawnsCount; ++i) idx += e.binomial[i][e.mapPawns[squares[i]]];
+    }
+    else {
+        if (rankOf(squares[0]) > 3)
+            for (int i = 0; i < size; ++i) squares[i] = flipRank(squares[i]);
+        // The first leading piece off the diagonal is brought below it.
+        for (int i = 0; i < d->groupLen[0]; ++i) {
+            if (!offDiagonal(squares[i])) continue;
+            if (offDiagonal(squares[i]) > 0)
+                for (int j = i; j < size; ++j) squares[j] = ((squares[j] >> 3) | (squares[j] << 3)) & 63;
+            break;
+        }
+        if (hasUniquePieces) {
+            Square s0 = squares[0], s1 = squares[1], s2 = squares[2];
+            int adjust1 = s1 > s0;
+            int adjust2 = (s2 > s0) + (s2 > s1);
+            if (offDiagonal(s0))
+                idx = (uint64_t(e.mapA1D1D4[s0]) * 63 + (s1 - adjust1)) * 62 + s2 - adjust2;
+            else if (offDiagonal(s1))
+                idx = (6 * 63 + rankOf(s0) * 28 + e.mapB1H1H7[s1]) * 62 + s2 - adjust2;
+            else if (offDiagonal(s2))
+                idx = 6 * 63 * 62 + 4 * 28 * 62 + rankOf(s0) * 7 * 28 + (rankOf(s1) - adjust1) * 28 + e.mapB1H1H7[s2];
+            else
+                idx = 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 + rankOf(s0) * 7 * 6 + (rankOf(s1) - adjust1) * 6
+                      + (rankOf(s2) - adjust2);
+        }
+        else
+            idx = e.mapKK[e.mapA1D1D4[squares[0]]][squares[1]];
+    }
+
+    // The other groups as combinations of the squares still free, the
+    // remaining pawns only ranging over the second to seventh ranks.
+    idx *= d->groupIdx[0];
+    Square* group = squares + d->groupLen[0];
+    bool remainingPawns = hasPawns && pawnCount[1];
+    for (int next = 1; d->groupLen[next]; ++next) {
+        std::stable_sort(group, group + d->groupLen[next]);
+        uint64_t n = 0;
+        for (int i = 0; i < d->groupLen[next]; ++i) {
+            int adjust = static_cast<int>(std::count_if(squares, group, [&](Square s) { return group[i] > s; }));
+            n += e.binomial[i + 1][group[i] - adjust - 8 * remainingPawns];
+        }
+        remainingPawns = false;
+        idx += n * d->groupIdx[next];
+        group += d->groupLen[next];
+    }
+    index = idx;
+    return d;
+}
+
+// Values are Huffman-coded symbols in fixed-size blocks, each symbol a
+// value or a pair of symbols. The sparse index gives the block and the
+// offset into it of every span-th position, the block lengths the rest.
+int SyzygyTable::decompress(const PairsData& d, uint64_t index) const {
+    if (d.flags & SingleValueFlag) return d.minSymLen;
+
+    auto blockLength = [&](uint32_t block) { return int(readLE16(d.blockLength + 2 * uint64_t(block))); };
+    const uint8_t* sparse = d.sparseIndex + 6 * (index / d.span);
+    uint32_t block = readLE32(sparse);
+    int offset = readLE16(sparse + 4) + static_cast<int>(index % d.span) - static_cast<int>(d.span / 2);
+    while (offset < 0) offset += blockLength(--block) + 1;
+    while (offset > blockLength(block)) offset -= blockLength(block++) + 1;
+
+    const uint8_t* ptr = d.data + block * d.blockSize;
+    uint64_t buf64 = readBE64(ptr);
+    ptr += 8;
+    int buf64Size = 64;
+    size_t sym;
+    for (;;) {
+        size_t len = 0;
+        while (buf64 < d.base64[len]) ++len;
+        sym = static_cast<size_t>((buf64 - d.base64[len]) >> (64 - len - d.minSymLen)) + readLE16(d.lowestSym + 2 * len);
+        if (offset < d.symlen[sym] + 1) break;
+        offset -= d.symlen[sym] + 1;
+        len += d.minSymLen;
+        buf64 <<= len;
+        buf64Size -= static_cast<int>(len);
+        if (buf64Size <= 32) {
+            buf64Size += 32;
+            buf64 |= uint64_t(readBE32(ptr)) << (64 - buf64Size);
+            ptr += 4;
+        }
+    }
+
+    // Walk down the pairs to the value at the offset.
+    auto left = [&](size_t s) { return size_t((d.btree[3 * s + 1] & 0xF) << 8 | d.btree[3 * s]); };
+    while (d.symlen[sym]) {
+        size_t l = left(sym);
+        if (offset < d.symlen[l] + 1) sym = l;
+        else {
+            offset -= d.symlen[l] + 1;
+            sym = size_t(d.btree[3 * sym + 2] << 4 | d.btree[3 * sym + 1] >> 4);
+        }
+    }
+    return static_cast<int>(left(sym));
+}
+
+SyzygyTable::Probe SyzygyTable::probeWDL(const BoardState& state, bool flipped, int& value) {
+    if (!load()) return Probe::Missing;
+    uint64_t index;
+    int tbFile;
+    PairsData* d = encode(state, flipped, index, tbFile);
+    value = decompress(*d, index) - 2;
+    return Probe::Ok;
+}
+
+SyzygyTable::Probe SyzygyTable::probeDTZ(const BoardState& state, bool flipped, int wdl, int& plies) {
+    if (!load()) return Probe::Missing;
+    uint64_t index;
+    int tbFile;
+    PairsData* d = encode(state, flipped, index, tbFile);
+    if (!d) return Probe::OtherSide;
+    int value = decompress(*d, index);
+
+    // Mapped values index the map of their result: win, loss, cursed win,
+    // blessed loss.
+    constexpr int MapOf[5] = { 1, 3, 0, 2, 0 };
+    const PairsData& first = items[0][tbFile];
+    if (first.flags & MappedFlag) {
+        size_t at = size_t(first.mapIdx[MapOf[wdl + 2]]) + value;
+        value = first.flags & WideFlag ? readLE16(dtzMap + 2 * at) : dtzMap[at];
+    }
+    // Stored in moves unless flagged as plies; the fifty-move results always are.
+    if ((wdl == 2 && !(first.flags & WinPliesFlag)) || (wdl == -2 && !(first.flags & LossPliesFlag)) || wdl == 1
+        || wdl == -1)
+        value *= 2;
+    plies = value + 1;
+    return Probe::Ok;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "boardstate.h"
+#include "mappedfile.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// One Syzygy table file, WDL (.rtbw) or DTZ (.rtbz), decoded in place: the
+// file is memory-mapped on the first probe and never copied, so every
+// process probing it shares a single page-cache copy. A probe returns the
+// value stored for the position and nothing more; capture resolution and
+// the side to move that a DTZ file leaves out are up to the caller (see
+// Tablebases).
+class SyzygyTable {
+public:
+    enum class Kind { WDL, DTZ };
+    enum class Probe { Ok, Missing, OtherSide };
+
+    // counts[colour][type] is the material the file is named after, White
+    // being the side written first ("KRvK").
+    SyzygyTable(Kind kind, std::string path, const int (&counts)[2][6]);
+    SyzygyTable(const SyzygyTable&) = delete;
+    SyzygyTable& operator=(const SyzygyTable&) = delete;
+
+    // Maps and parses the file on the first call from any thread; false if
+    // it is missing or malformed.
+    bool load();
+
+    // flipped: the position holds the named material with the colours
+    // swapped. The WDL value is -2..2, as WDLScore.
+    Probe probeWDL(const BoardState& state, bool flipped, int& value);
+    // Distance to zeroing of a position whose WDL value is wdl, in plies.
+    // Tables stored in moves give the odd ply count rounded up. OtherSide
+    // when the file only stores the other side to move.
+    Probe probeDTZ(const BoardState& state, bool flipped, int wdl, int& plies);
+
+    static constexpr int MaxPieces = 7;
+
+private:
+    struct PairsData {
+        uint8_t flags = 0;
+        int maxSymLen = 0;
+        int minSymLen = 0;   // the stored value of single-value tables
+        uint32_t numBlocks = 0;
+        uint64_t blockSize = 0;
+        uint64_t span = 0;   // positions per sparse index entry
+        const uint8_t* lowestSym = nullptr;
+        const uint8_t* btree = nullptr;
+        const uint8_t* blockLength = nullptr;
+        uint32_t blockLengthSize = 0;
+        const uint8_t* sparseIndex = nullptr;
+        uint64_t sparseIndexSize = 0;
+        const uint8_t* data = nullptr;
+        std::vector<uint64_t> base64;
+        std::vector<uint8_t> symlen;
+        int pieces[MaxPieces] = {};
+        uint64_t groupIdx[MaxPieces + 1] = {};
+        int groupLen[MaxPieces + 1] = {};
+        uint16_t mapIdx[4] = {};
+    };
+
+    bool parse(const uint8_t* data, const uint8_t* end);
+    // Reads one PairsData header; null if it runs past end.
+    const uint8_t* setSizes(PairsData& d, const uint8_t* data, const uint8_t* end);
+    void setGroups(PairsData& d, const int (&order)[2], int file);
+    const uint8_t* setDTZMap(const uint8_t* data, int files);
+    // Index of the position in its PairsData; null when the side to move is
+    // not stored.
+    PairsData* encode(const BoardState& state, bool flipped, uint64_t& index, int& file);
+    int decompress(const PairsData& d, uint64_t index) const;
+
+    Kind kind;
+    std::string path;
+    int pieceCount = 0;
+    bool hasPawns = false;
+    bool hasUniquePieces = false;
+    bool symmetric = false;
+    int pawnCount[2] = {};   // lead colour first
+    int sides = 1;
+
+    std::once_flag once;
+    MappedFile file;
+    bool valid = false;
+    PairsData items[2][4];   // [side to move][file of the leading pawn]
+    const uint8_t* dtzMap = nullptr;
+};
@@ -0,0 +1,518 @@
+#include "tablebase.h"
+
+#include "bitboard.h"
+#include "syzygy.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Tablebases {
+
+namespace {
+
+// Built-in fallback: KQvK, KRvK and KPvK solved by retrograde analysis in
+// memory when no file covers them. Tables are kept with the strong side
+// (the one with the extra piece) as White; positions where Black is strong
+// are mirrored vertically first.
+// Index: weak side to move, strong king, weak king, strong piece.
+constexpr int TableSize = 2 * 64 * 64 * 64;
+
+int indexOf(bool weakToMove, Square strongKing, Square weakKing, Square piece) {
+    return ((int(weakToMove) * 64 + strongKing) * 64 + weakKing) * 64 + piece;
+}
+
+// Result for the side to move; dtz counts plies to the next zeroing move
+// or mate, so a mated side has dtz 0.
+struct Entry {
+    int8_t wdl;   // -1 loss, 0 draw, 1 win
+    uint8_t dtz;
+};
+
+constexpr int8_t Unknown = -128;
+
+std::vector<Entry> queenTable, rookTable, pawnTable;
+bool builtInReady = false;
+
+const std::vector<Entry>* tableFor(PieceType type) {
+    switch (type) {
+    case PieceType::Queen: return &queenTable;
+    case PieceType::Rook: return &rookTable;
+    case PieceType::Pawn: return &pawnTable;
+    default: return nullptr;
+    }
+}
+
+Bitboard strongAttacks(PieceType type, Square piece, Bitboard occupied) {
+    return type == PieceType::Pawn ? pawnAttacks(PieceColor::White, piece) : pieceAttacks(type, piece, occupied);
+}
+
+bool legal(PieceType type, bool weakToMove, Square sk, Square wk, Square piece) {
+    if (sk == wk || piece == sk || piece == wk || (kingAttacks(sk) & squareBB(wk))) return false;
+    if (type == PieceType::Pawn && (rankOf(piece) == 0 || rankOf(piece) == 7)) return false;
+    // The side that just moved cannot have left its king in check.
+    return weakToMove || !(strongAttacks(type, piece, squareBB(sk) | squareBB(wk)) & squareBB(wk));
+}
+
+// Solves the positions with the strong piece on one of the given squares.
+// Moves of the strong piece either stay inside that set (queen, rook) or
+// zero the fifty-move count (pawn), so a slice only depends on positions
+// already solved: pawn pushes lead to higher ranks, promotions to the queen
+// and rook tables, and capturing the piece to a draw.
+void solveSlice(PieceType type, std::vector<Entry>& table, Bitboard pieceSquares) {
+    std::vector<uint8_t> moves(TableSize, 0);
+    std::vector<uint8_t> drawExit(TableSize, 0);
+    std::vector<int> seeds[2];   // by dtz, 0 or 1
+
+    auto resolve = [&](int i, int8_t wdl, int dtz) {
+        table[i] = { wdl, static_cast<uint8_t>(dtz) };
+        seeds[dtz].push_back(i);
+    };
+
+    for (int weakToMove = 0; weakToMove < 2; ++weakToMove)
+        for (Square sk = 0; sk < 64; ++sk)
+            for (Square wk = 0; wk < 64; ++wk)
+                for (Bitboard b = pieceSquares; b;) {
+                    Square piece = popLsb(b);
+                    int i = indexOf(weakToMove, sk, wk, piece);
+                    if (!legal(type, weakToMove, sk, wk, piece)) {
+                        table[i] = { 0, 0 };
+                        continue;
+                    }
+                    table[i] = { Unknown, 0 };
+                    Bitboard occupied = squareBB(sk) | squareBB(wk) | squareBB(piece);
+                    int count = 0;
+                    bool winExit = false, lossExit = false, checked = false;
+                    if (weakToMove) {
+                        Bitboard guarded = kingAttacks(sk) | strongAttacks(type, piece, occupied ^ squareBB(wk));
+                        checked = (guarded & squareBB(wk)) != 0;
+                        Bitboard targets = kingAttacks(wk) & ~guarded;
+                        // Taking the piece leaves two bare kings.
+                        drawExit[i] = (targets & squareBB(piece)) != 0;
+                        count = popCount(targets & ~squareBB(piece));
+                    }
+                    else {
+                        count = popCount(kingAttacks(sk) & ~kingAttacks(wk) & ~occupied);
+                        if (type != PieceType::Pawn) {
+                            count += popCount(pieceAttacks(type, piece, occupied) & ~occupied);
+                        }
+                        else if (!(occupied & squareBB(piece + 8))) {
+                            auto zeroing = [&](int8_t wdl) {
+                                winExit |= wdl < 0;
+                                lossExit |= wdl > 0;
+                                drawExit[i] |= wdl == 0;
+                            };
+                            Square to = piece + 8;
+                            if (rankOf(to) == 7) {
+                                // Minor promotions draw; a rook can still win
+                                // where a queen would stalemate.
+                                zeroing(queenTable[indexOf(true, sk, wk, to)].wdl);
+                                zeroing(rookTable[indexOf(true, sk, wk, to)].wdl);
+                                zeroing(0);
+                            }
+                            else {
+                                zeroing(table[indexOf(true, sk, wk, to)].wdl);
+                                if (rankOf(piece) == 1 && !(occupied & squareBB(to + 8)))
+                                    zeroing(table[indexOf(true, sk, wk, to + 8)].wdl);
+                            }
+                        }
+                    }
+                    if (winExit) resolve(i, 1, 1);
+                    else if (count == 0 && !drawExit[i] && (lossExit || checked)) resolve(i, -1, lossExit ? 1 : 0);
+                    else if (count == 0) table[i] = { 0, 0 };
+                    moves[i] = static_cast<uint8_t>(count);
+                }
+
+    // Breadth-first through the moves that keep the fifty-move count
+    // running, so every position is reached first at its shortest distance.
+    std::vector<int> queue = std::move(seeds[0]);
+    queue.insert(queue.end(), seeds[1].begin(), seeds[1].end());
+    for (size_t head = 0; head < queue.size(); ++head) {
+        int i = queue[head];
+        Entry e = table[i];
+        bool weakToMove = i >> 18;
+        Square sk = (i >> 12) & 63, wk = (i >> 6) & 63, piece = i & 63;
+        Bitboard occupied = squareBB(sk) | squareBB(wk) | squareBB(piece);
+
+        auto visit = [&](int p) {
+            if (table[p].wdl != Unknown) return;
+            if (e.wdl < 0) {
+                table[p] = { 1, static_cast<uint8_t>(e.dtz + 1) };
+                queue.push_back(p);
+            }
+            else if (--moves[p] == 0 && !drawExit[p]) {
+                table[p] = { -1, static_cast<uint8_t>(e.dtz + 1) };
+                queue.push_back(p);
+            }
+        };
+
+        if (weakToMove) {
+            // The strong side moved last: its king or a non-pawn piece.
+            for (Bitboard b = kingAttacks(sk) & ~occupied; b;) {
+                Square from = popLsb(b);
+                if (legal(type, false, from, wk, piece)) visit(indexOf(false, from, wk, piece));
+            }
+            if (type != PieceType::Pawn)
+                for (Bitboard b = pieceAttacks(type, piece, occupied) & ~occupied; b;) {
+                    Square from = popLsb(b);
+                    if (legal(type, false, sk, wk, from)) visit(indexOf(false, sk, wk, from));
+                }
+        }
+        else {
+            for (Bitboard b = kingAttacks(wk) & ~occupied; b;) {
+                Square from = popLsb(b);
+                if (legal(type, true, sk, from, piece)) visit(indexOf(true, sk, from, piece));
+            }
+        }
+    }
+
+    // Whatever the winning side cannot force is a draw.
+    for (int weakToMove = 0; weakToMove < 2; ++weakToMove)
+        for (Square sk = 0; sk < 64; ++sk)
+            for (Square wk = 0; wk < 64; ++wk)
+                for (Bitboard b = pieceSquares; b;) {
+                    Entry& e = table[indexOf(weakToMove, sk, wk, popLsb(b))];
+                    if (e.wdl == Unknown) e = { 0, 0 };
+                }
+}
+
+void generate() {
+    queenTable.assign(TableSize, { 0, 0 });
+    rookTable.assign(TableSize, { 0, 0 });
+    pawnTable.assign(TableSize, { 0, 0 });
+    solveSlice(PieceType::Queen, queenTable, ~Bitboard(0));
+    solveSlice(PieceType::Rook, rookTable, ~Bitboard(0));
+    for (int rank = 6; rank >= 1; --rank) solveSlice(PieceType::Pawn, pawnTable, Rank1BB << (8 * rank));
+    builtInReady = true;
+}
+
+void release() {
+    builtInReady = false;
+    std::vector<Entry>().swap(queenTable);
+    std::vector<Entry>().swap(rookTable);
+    std::vector<Entry>().swap(pawnTable);
+}
+
+constexpr int BuiltInCardinality = 3;
+
+// KvK and a lone knight or bishop against a bare king cannot be mated in
+// any line, so they are draws whatever the tables say.
+bool builtInDraw(const BoardState& state) {
+    if (popCount(state.occupied) > BuiltInCardinality) return false;
+    return !(state.typeBB(PieceType::Pawn) | state.typeBB(PieceType::Rook) | state.typeBB(PieceType::Queen));
+}
+
+bool builtInLookup(const BoardState& state, Entry& result) {
+    if (!builtInReady || popCount(state.occupied) != BuiltInCardinality) return false;
+    Square piece = lsb(state.occupied & ~state.typeBB(PieceType::King));
+    const std::vector<Entry>* table = tableFor(state.typeAt(piece));
+    if (!table) return false;
+    PieceColor strong = state.colorAt(piece);
+    int flip = strong == PieceColor::White ? 0 : 56;
+    result = (*table)[indexOf(state.sideToMove != strong, lsb(state.bb(strong, PieceType::King)) ^ flip,
+                              lsb(state.bb(~strong, PieceType::King)) ^ flip, piece ^ flip)];
+    return true;
+}
+
+// Piece counts of both sides, four bits per non-king piece kind.
+using Material = uint32_t;
+using Counts = int[2][6];
+
+constexpr const char* PieceLetters = "KQRBNP";
+
+Material materialOf(const Counts& counts) {
+    Material m = 0;
+    for (int side = 0; side < 2; ++side)
+        for (int t = typeIndex(PieceType::Queen); t <= typeIndex(PieceType::Pawn); ++t)
+            m |= Material(counts[side][t]) << (4 * (side * 5 + t - 1));
+    return m;
+}
+
+Material materialOf(const BoardState& state, PieceColor strong) {
+    Counts counts = {};
+    for (int side = 0; side < 2; ++side)
+        for (int t = 0; t < 6; ++t)
+            counts[side][t] = popCount(state.bb(side == 0 ? strong : ~strong, static_cast<PieceType>(t)));
+    return materialOf(counts);
+}
+
+// Parses a table name such as "KRPvKR"; false for anything else.
+bool countsOf(const std::string& name, Counts& counts) {
+    std::memset(counts, 0, sizeof(counts));
+    int side = 0, pieces = 0;
+    for (char ch : name) {
+        if (ch == 'v') {
+            if (++side > 1) return false;
+            continue;
+        }
+        const char* p = ch ? std::strchr(PieceLetters, ch) : nullptr;
+        if (!p || ++pieces > SyzygyTable::MaxPieces) return false;
+        ++counts[side][p - PieceLetters];
+    }
+    return side == 1 && counts[0][0] == 1 && counts[1][0] == 1;
+}
+
+struct Table {
+    int pieces = 0;
+    std::unique_ptr<SyzygyTable> wdl;
+    std::unique_ptr<SyzygyTable> dtz;
+};
+
+std::vector<std::unique_ptr<Table>> tables;
+std::unordered_map<Material, Table*> byMaterial;
+int maxPieces = 0;
+
+Table* find(const BoardState& state, bool& flipped) {
+    auto it = byMaterial.find(materialOf(state, PieceColor::White));
+    flipped = false;
+    if (it == byMaterial.end()) {
+        it = byMaterial.find(materialOf(state, PieceColor::Black));
+        flipped = true;
+        if (it == byMaterial.end()) return nullptr;
+    }
+    return it->second;
+}
+
+// Castling rights never matter with so little material but cannot be
+// represented in the tables either, so such positions are left to search.
+bool covered(const BoardState& state) {
+    return popCount(state.occupied) <= cardinality() && !state.castling;
+}
+
+bool zeroingMove(const BoardState& state, Move m) {
+    return (m.flags() & CaptureMove) || state.typeAt(m.from()) == PieceType::Pawn;
+}
+
+int sign(int v) { return (v > 0) - (v < 0); }
+
+// Plies of a winning or losing first move that itself zeroes the count.
+int dtzBeforeZeroing(int wdl) {
+    return wdl == 2 ? 1 : wdl == 1 ? 101 : wdl == -1 ? -101 : wdl == -2 ? -1 : 0;
+}
+
+// WDL value stored for the position itself, from a file or the built-in
+// tables, without looking at captures.
+bool probeStored(const BoardState& state, int& value) {
+    if (builtInDraw(state)) {
+        value = 0;
+        return true;
+    }
+    bool flipped;
+    Table* t = find(state, flipped);
+    if (t && t->wdl && t->wdl->probeWDL(state, flipped, value) == SyzygyTable::Probe::Ok) return true;
+    Entry e;
+    if (!builtInLookup(state, e)) return false;
+    value = e.wdl * (e.dtz > 100 ? 1 : 2);
+    return true;
+}
+
+// Files leave out positions where a capture (en passant included) is best,
+// so captures are searched and the stored value only stands when no
+// capture matches it. With zeroing, pawn moves are searched too, and
+// zeroingBest tells whether the result comes from such a move. False when
+// a position on the way is not covered.
+bool searchWDL(const BoardState& state, bool zeroing, int& result, bool& zeroingBest) {
+    MoveList moves;
+    generateLegalMoves(state, moves);
+    int best = -3, searched = 0;
+    zeroingBest = false;
+    for (Move m : moves) {
+        if (!(m.flags() & CaptureMove) && (!zeroing || state.typeAt(m.from()) != PieceType::Pawn)) continue;
+        ++searched;
+        BoardState child = state;
+        child.makeMove(m);
+        int value;
+        bool unused;
+        if (!searchWDL(child, false, value, unused)) return false;
+        best = std::max(best, -value);
+        if (best == 2) {
+            result = best;
+            zeroingBest = true;
+            return true;
+        }
+    }
+    // With every move searched the stored value is not needed, and may be
+    // wrong: it ignores en passant.
+    bool allSearched = searched && searched == moves.size();
+    int stored = best;
+    if (!allSearched && !probeStored(state, stored)) return false;
+    if (best >= stored) {
+        result = best;
+        zeroingBest = best > 0 || allSearched;
+    }
+    else
+        result = stored;
+    return true;
+}
+
+} // namespace
+
+void init(const std::string& paths) {
+    byMaterial.clear();
+    tables.clear();
+    maxPieces = 0;
+#if defined(_WIN32)
+    const char separator = ';';
+#else
+    const char separator = ':';
+#endif
+    size_t start = 0;
+    while (start <= paths.size()) {
+        size_t end = paths.find(separator, start);
+        if (end == std::string::npos) end = paths.size();
+        std::string dir = paths.substr(start, end - start);
+        start = end + 1;
+        if (dir.empty() || dir == "<empty>") continue;
+
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+            const std::filesystem::path& p = entry.path();
+            std::string ext = p.extension().string();
+            if (ext != ".rtbw" && ext != ".rtbz") continue;
+            Counts counts;
+            if (!countsOf(p.stem().string(), counts)) continue;
+            Table*& t = byMaterial[materialOf(counts)];
+            if (!t) {
+                tables.push_back(std::make_unique<Table>());
+                t = tables.back().get();
+            }
+            // The first directory listing a table wins.
+            bool wdl = ext == ".rtbw";
+            std::unique_ptr<SyzygyTable>& slot = wdl ? t->wdl : t->dtz;
+            if (slot) continue;
+            slot = std::make_unique<SyzygyTable>(wdl ? SyzygyTable::Kind::WDL : SyzygyTable::Kind::DTZ, p.string(), counts);
+            t->pieces = 0;
+            for (const auto& side : counts)
+                for (int n : side) t->pieces += n;
+            if (wdl) maxPieces = std::max(maxPieces, t->pieces);
+        }
+    }
+
+    // The solver is only needed for what the files leave out, and is run
+    // here rather than on a first probe in the middle of a search.
+    bool needed = false;
+    for (const char* name : { "KQvK", "KRvK", "KPvK" }) {
+        Counts counts;
+        countsOf(name, counts);
+        auto it = byMaterial.find(materialOf(counts));
+        Table* t = it == byMaterial.end() ? nullptr : it->second;
+        needed |= !t || !t->wdl || !t->dtz || !t->wdl->load() || !t->dtz->load();
+    }
+    if (needed && !builtInReady) generate();
+    else if (!needed) release();
+}
+
+int cardinality() { return std::max(maxPieces, BuiltInCardinality); }
+
+int tableCount() {
+    int n = 0;
+    for (const auto& t : tables) n += t->wdl != nullptr;
+    return n;
+}
+
+bool probeWDL(const BoardState& state, WDLScore& result) {
+    if (!covered(state)) return false;
+    int value;
+    bool zeroingBest;
+    if (!searchWDL(state, false, value, zeroingBest)) return false;
+    result = static_cast<WDLScore>(value);
+    return true;
+}
+
+bool probeDTZ(const BoardState& state, int& result) {
+    if (!covered(state)) return false;
+    MoveList moves;
+    generateLegalMoves(state, moves);
+    int wdl;
+    bool zeroingBest;
+    if (moves.empty() || !searchWDL(state, true, wdl, zeroingBest)) {
+        result = 0;
+        return moves.empty();
+    }
+    if (!wdl || zeroingBest) {
+        result = dtzBeforeZeroing(wdl);
+        return true;
+    }
+
+    bool flipped;
+    Table* t = find(state, flipped);
+    int plies;
+    switch (t && t->dtz ? t->dtz->probeDTZ(state, flipped, wdl, plies) : SyzygyTable::Probe::Missing) {
+    case SyzygyTable::Probe::Ok:
+        result = (plies + (std::abs(wdl) == 1 ? 100 : 0)) * sign(wdl);
+        return true;
+    case SyzygyTable::Probe::OtherSide: {
+        // One ply on, where the file does store the side to move: the
+        // quickest win or the longest loss over the moves that keep the
+        // result.
+        int best = 0;
+        for (Move m : moves) {
+            BoardState child = state;
+            child.makeMove(m);
+            MoveList replies;
+            generateLegalMoves(child, replies);
+            int dtz, value;
+            bool unused;
+            if (replies.empty()) dtz = inCheck(child) ? 1 : 0;
+            else if (zeroingMove(state, m)) {
+                if (!searchWDL(child, false, value, unused)) return false;
+                dtz = -dtzBeforeZeroing(value);
+            }
+            else {
+                if (!probeDTZ(child, dtz)) return false;
+                dtz = -dtz + sign(-dtz);
+            }
+            if (sign(dtz) == sign(wdl) && (!best || dtz < best)) best = dtz;
+        }
+        result = best ? best : -1;
+        return true;
+    }
+    case SyzygyTable::Probe::Missing:
+        break;
+    }
+    Entry e;
+    if (!builtInLookup(state, e)) return false;
+    result = e.wdl * e.dtz;
+    return true;
+}
+
+bool filterRootMoves(const BoardState& root, MoveList& moves) {
+    if (!covered(root) || moves.empty()) return false;
+    struct RankedMove {
+        Move move;
+        int rank;    // the WDL value for the mover, fifty-move rule applied
+        int order;   // ascending: quicker wins, longer losses
+    };
+    std::vector<RankedMove> ranked;
+    for (Move m : moves) {
+        BoardState child = root;
+        child.makeMove(m);
+        WDLScore wdl;
+        int dtz;
+        if (!probeWDL(child, wdl) || !probeDTZ(child, dtz)) return false;
+        bool zeroing = (m.flags() & CaptureMove) || root.typeAt(m.from()) == PieceType::Pawn;
+        int plies = zeroing ? 1 : std::abs(dtz) + 1;
+        int rank = -static_cast<int>(wdl);
+        // A result the count runs out on before the next zeroing move is a draw.
+        if (std::abs(rank) == 2 && root.halfmoveClock + plies > 100) rank /= 2;
+        ranked.push_back({ m, rank, rank > 0 ? plies : rank < 0 ? -plies : 0 });
+    }
+    std::stable_sort(ranked.begin(), ranked.end(), [](const RankedMove& a, const RankedMove& b) {
+        return a.rank != b.rank ? a.rank > b.rank : a.order < b.order;
+    });
+    // Every tablebase win scores alike inside the search, so a won or lost
+    // root keeps only its DTZ-optimal moves; otherwise the search would be
+    // free to shuffle until the fifty-move count forced progress.
+    const RankedMove best = ranked[0];
+    bool decisive = std::abs(best.rank) == 2;
+    moves.count = 0;
+    for (const RankedMove& r : ranked)
+        if (r.rank == best.rank && (!decisive || r.order == best.order)) moves.moves[moves.count++] = r.move;
+    return true;
+}
+
+} // namespace Tablebases
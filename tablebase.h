@@ -0,0 +1,49 @@
+#pragma once
+
+#include "boardstate.h"
+#include "movegen.h"
+
+#include <string>
+
+enum class WDLScore : int8_t {
+    Loss = -2,
+    BlessedLoss = -1,   // loss, but drawn under the fifty-move rule
+    Draw = 0,
+    CursedWin = 1,      // win, but drawn under the fifty-move rule
+    Win = 2
+};
+
+// Endgame tablebase probing. Syzygy files are discovered by name when the
+// paths are set and memory-mapped on first probe, so idle tables cost no
+// memory and every process on the host shares one page-cache copy. When no
+// file covers KQvK, KRvK or KPvK, built-in tables solved by retrograde
+// analysis stand in (about 3 MB and a fifth of a second, spent in init);
+// positions without mating material are recognised directly.
+namespace Tablebases {
+
+// Replaces the search path: directories separated by ';' on Windows and
+// ':' elsewhere, as in the UCI SyzygyPath option, and builds the fallback
+// tables if they are needed. Not safe during a search.
+void init(const std::string& paths);
+
+// Largest piece count (kings included) that a probe can answer.
+int cardinality();
+// Number of material signatures with a WDL table on disk.
+int tableCount();
+
+// WDL value from the side to move's point of view, assuming the halfmove
+// clock has just been reset. False when the position is not covered.
+bool probeWDL(const BoardState& state, WDLScore& result);
+// Plies to the next capture, pawn move or mate with best play, from the side
+// to move's point of view: positive when winning, negative when losing, zero
+// for draws and for a side that is already mated. False when the position is
+// not covered.
+bool probeDTZ(const BoardState& state, int& result);
+
+// Narrows the root moves to those that keep the best result still reachable
+// under the fifty-move rule; when that result is a win or a loss, only the
+// moves with the quickest win or the longest loss by DTZ remain. False, with
+// the moves untouched, when the position is not covered.
+bool filterRootMoves(const BoardState& root, MoveList& moves);
+
+} // namespace Tablebases
@@ -0,0 +1,162 @@
+#include "thread.h"
+
+SearchPool::SearchPool(const Evaluator& prototypeEvaluator, TranspositionTable& tt, int threads)
+    : prototype(prototypeEvaluator.clone()), tt(tt) {
+    spawn(threads);
+}
+
+SearchPool::~SearchPool() {
+    stop();
+    wait();
+    shutdown();
+}
+
+void SearchPool::setThreadCount(int threads) {
+    stop();
+    wait();
+    shutdown();
+    spawn(threads);
+}
+
+void SearchPool::setEvaluator(const Evaluator& prototypeEvaluator) {
+    int threads = threadCount();
+    stop();
+    wait();
+    shutdown();
+    prototype = prototypeEvaluator.clone();
+    spawn(threads);
+}
+
+void SearchPool::setFeatures(const SearchFeatures& f) {
+    stop();
+    wait();
+    features = f;
+    for (auto& w : workers) w->search->setFeatures(features);
+}
+
+void SearchPool::clearHistory() {
+    stop();
+    wait();
+    for (auto& w : workers) w->search->clearHistory();
+}
+
+void SearchPool::spawn(int threads) {
+    if (threads < 1) threads = 1;
+    quit = false;
+    // All per-thread search state is allocated here, before any search runs.
+    for (int i = 0; i < threads; ++i) {
+        auto w = std::make_unique<Worker>();
+        w->evaluator = prototype->clone();
+        w->search = std::make_unique<Search>(*w->evaluator, tt);
+        w->search->setStopFlag(&stopFlag);
+        w->search->setPonderFlag(&ponderFlag);
+        w->search->setFeatures(features);
+        w->job = job;
+        workers.push_back(std::move(w));
+    }
+    workers[0]->search->onIteration = [this](const SearchInfo& info) {
+        if (onIteration) onIteration(info);
+    };
+    for (int i = 0; i < threads; ++i)
+        workers[i]->thread = std::thread(&SearchPool::workerLoop, this, i);
+}
+
+void SearchPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wakeUp.notify_all();
+    for (auto& w : workers)
+        if (w->thread.joinable()) w->thread.join();
+    workers.clear();
+}
+
+void SearchPool::start(const BoardState& position, const SearchLimits& searchLimits, const KeyHistory* history) {
+    wait();
+    std::lock_guard<std::mutex> lock(mutex);
+    root = position;
+    rootHistory.clear();
+    if (history) rootHistory = *history;
+    limits = searchLimits;
+    stopFlag.store(false, std::memory_order_relaxed);
+    ponderFlag.store(searchLimits.ponder, std::memory_order_relaxed);
+    tt.newSearch();
+    running = threadCount();
+    ++job;
+    wakeUp.notify_all();
+}
+
+SearchResult SearchPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this] { return running == 0; });
+    return lastResult;
+}
+
+bool SearchPool::searching() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return running != 0;
+}
+
+void SearchPool::workerLoop(int id) {
+    Worker& self = *workers[id];
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wakeUp.wait(lock, [&] { return quit || self.job != job; });
+        if (quit) return;
+        self.job = job;
+        BoardState position = root;
+        SearchLimits searchLimits = limits;
+        lock.unlock();
+
+        // rootHistory is only rewritten by start(), after every worker is done.
+        SearchResult result = self.search->run(position, searchLimits, id, &rootHistory);
+        // The main thread owns the limits; once it is done everyone stops.
+        if (id == 0) stop();
+
+        lock.lock();
+        self.result = std::move(result);
+        if (running == 1) {
+            // Last one out publishes the result. The callback runs before
+            // wait() can return, so callers never see a stale notification.
+            lastResult = pickResult();
+            result = lastResult;
+            auto callback = onFinished;
+            lock.unlock();
+            if (callback) callback(result);
+            lock.lock();
+        }
+        if (--running == 0) finished.notify_all();
+    }
+}
+
+SearchResult SearchPool::pickResult() const {
+    // The deepest completed iteration wins; ties go to the main thread, whose
+    // node count and timing describe the whole search.
+    const SearchResult* best = &workers[0]->result;
+    for (const auto& w : workers)
+        if (w->result.depth > best->depth && w->result.bestMove != NoMove) best = &w->result;
+    SearchResult r = *best;
+    r.nodes = 0;
+    r.stats = SearchStats();
+    for (const auto& w : workers) {
+        r.nodes += w->result.nodes;
+        r.stats += w->result.stats;
+    }
+    r.timeMs = workers[0]->result.timeMs;
+    return r;
+}
+
+std::vector<ThreadStats> SearchPool::stats() const {
+    std::vector<ThreadStats> out;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& w : workers)
+        out.push_back({ w->search->nodesSearched(), w->result.depth, w->result.timeMs, w->result.stats });
+    return out;
+}
+
+uint64_t SearchPool::nodesSearched() const {
+    uint64_t total = 0;
+    for (const auto& w : workers) total += w->search->nodesSearched();
+    return total;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "search.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct ThreadStats {
+    uint64_t nodes;
+    int depth;
+    int64_t timeMs;
+    SearchStats search;
+};
+
+// Lazy SMP: every thread searches the same root with its own position copy,
+// evaluator, history and move stacks, and they cooperate only through the
+// shared transposition table. Workers are created once and parked between
+// searches, so starting a search costs a notify rather than thread creation.
+class SearchPool {
+public:
+    SearchPool(const Evaluator& prototype, TranspositionTable& tt, int threads = 1);
+    ~SearchPool();
+    SearchPool(const SearchPool&) = delete;
+    SearchPool& operator=(const SearchPool&) = delete;
+
+    // Waits for any running search, then rebuilds the workers.
+    void setThreadCount(int threads);
+    int threadCount() const { return static_cast<int>(workers.size()); }
+    // Waits for any running search, then rebuilds the workers around clones
+    // of the new prototype.
+    void setEvaluator(const Evaluator& prototype);
+    // Waits for any running search, then applies to every worker.
+    void setFeatures(const SearchFeatures& f);
+    // Waits for any running search, then clears every worker's history.
+    void clearHistory();
+
+    // Starts a search on the worker threads and returns immediately. history
+    // holds the keys of the game leading to root, for repetition detection.
+    void start(const BoardState& root, const SearchLimits& limits, const KeyHistory* history = nullptr);
+    // Blocks until the running search (if any) has finished.
+    SearchResult wait();
+    SearchResult think(const BoardState& root, const SearchLimits& limits, const KeyHistory* history = nullptr) {
+        start(root, limits, history);
+        return wait();
+    }
+    void stop() { stopFlag.store(true, std::memory_order_relaxed); }
+    // Hands the clock to a search started with limits.ponder; it carries on
+    // from where pondering got to.
+    void ponderhit() { ponderFlag.store(false, std::memory_order_relaxed); }
+    bool searching() const;
+
+    // Sum over all threads; safe to call while searching.
+    uint64_t nodesSearched() const;
+    // Per-thread counters of the last (or current) search.
+    std::vector<ThreadStats> stats() const;
+
+    // Forwarded from the main thread after every completed iteration.
+    std::function<void(const SearchInfo&)> onIteration;
+    // Runs on a worker thread once every thread has stopped; it must not
+    // start or wait for a search itself.
+    std::function<void(const SearchResult&)> onFinished;
+
+private:
+    struct Worker {
+        std::unique_ptr<Evaluator> evaluator;
+        std::unique_ptr<Search> search;
+        SearchResult result;
+        std::thread thread;
+        uint64_t job = 0;
+    };
+
+    void spawn(int threads);
+    void shutdown();
+    void workerLoop(int id);
+    SearchResult pickResult() const;
+
+    std::unique_ptr<Evaluator> prototype;
+    SearchFeatures features;
+    TranspositionTable& tt;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<bool> stopFlag{ false };
+    std::atomic<bool> ponderFlag{ false };
+
+    mutable std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::condition_variable finished;
+    BoardState root;
+    KeyHistory rootHistory;
+    SearchLimits limits;
+    uint64_t job = 0;
+    int running = 0;
+    bool quit = false;
+    SearchResult lastResult;
+};
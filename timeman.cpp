@@ -0,0 +1,59 @@
+#include "timeman.h"
+
+#include <algorithm>
+
+namespace {
+
+// Moves the remaining time is spread over in sudden death.
+constexpr int SuddenDeathHorizon = 35;
+// Neither limit may use more than this share of the clock (in percent),
+// except on the last move before the time control.
+constexpr int MaxClockShare = 40;
+constexpr int LastMoveShare = 90;
+constexpr int MaximumRatio = 5;   // maximum = optimum * MaximumRatio, capped
+
+// The soft limit after an iteration, as a percentage of the optimum: from
+// 140% when the best move just changed down to 80% after six stable
+// iterations; a score drop adds up to another 100%.
+constexpr int UnstableScale = 140;
+constexpr int StableStep = 10;
+constexpr int MaxStableIterations = 6;
+constexpr int ScoreDropCap = 100;
+// The next iteration usually costs more than all previous ones together,
+// so it is not started past this share of the soft limit.
+constexpr int StartNextShare = 60;
+
+} // namespace
+
+void TimeManager::start(int64_t remainingMs, int64_t incrementMs, int movesToGo, int64_t overheadMs) {
+    int64_t available = std::max<int64_t>(1, remainingMs - overheadMs);
+    int horizon = movesToGo > 0 ? std::min(movesToGo, SuddenDeathHorizon) : SuddenDeathHorizon;
+    int64_t cap = available * (movesToGo == 1 ? LastMoveShare : MaxClockShare) / 100;
+
+    optimum = std::clamp<int64_t>(available / horizon + incrementMs * 3 / 4, 1, std::max<int64_t>(1, cap / 2));
+    maximum = std::clamp<int64_t>(optimum * MaximumRatio, optimum, std::max<int64_t>(optimum, cap));
+    fixed = false;
+    lastBestMove = NoMove;
+    stableIterations = 0;
+    lastScore = 0;
+    iterations = 0;
+}
+
+void TimeManager::startFixed(int64_t movetimeMs) {
+    optimum = maximum = std::max<int64_t>(1, movetimeMs);
+    fixed = true;
+}
+
+bool TimeManager::stopAfterIteration(int64_t elapsedMs, Move bestMove, int score) {
+    if (!enabled() || fixed) return false;
+
+    stableIterations = bestMove == lastBestMove ? std::min(stableIterations + 1, MaxStableIterations) : 0;
+    int drop = iterations ? std::clamp(lastScore - score, 0, ScoreDropCap) : 0;
+    lastBestMove = bestMove;
+    lastScore = score;
+    ++iterations;
+
+    int64_t scale = (UnstableScale - StableStep * stableIterations) * (100 + drop) / 100;
+    int64_t soft = std::min(maximum, optimum * scale / 100);
+    return elapsedMs * 100 >= soft * StartNextShare;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "types.h"
+
+#include <cstdint>
+
+// Splits the clock into an optimum time, the soft limit checked between
+// iterations, and a maximum, the hard limit that aborts the running one.
+// The optimum is scaled after every iteration: a best move that keeps
+// changing or a falling score buys more time, a stable one less.
+class TimeManager {
+public:
+    // Clock mode. movesToGo is zero for sudden death; overheadMs is kept in
+    // reserve per move for communication and scheduling lag.
+    void start(int64_t remainingMs, int64_t incrementMs, int movesToGo, int64_t overheadMs);
+    // Fixed time per move: the hard limit only, no early stop.
+    void startFixed(int64_t movetimeMs);
+    void disable() { optimum = maximum = 0; fixed = false; }
+
+    bool enabled() const { return maximum != 0; }
+    int64_t optimumMs() const { return optimum; }
+    int64_t maximumMs() const { return maximum; }
+
+    bool hardLimitReached(int64_t elapsedMs) const { return maximum && elapsedMs >= maximum; }
+    // Called after each completed iteration; true if another one is not
+    // worth starting.
+    bool stopAfterIteration(int64_t elapsedMs, Move bestMove, int score);
+
+private:
+    int64_t optimum = 0;
+    int64_t maximum = 0;
+    bool fixed = false;
+    Move lastBestMove = NoMove;
+    int stableIterations = 0;
+    int lastScore = 0;
+    int iterations = 0;
+};
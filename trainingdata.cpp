@@ -0,0 +1,135 @@
+#include "trainingdata.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr char Magic[8] = { 'C', 'H', '1', 'D', 'A', 'T', 'A', '\0' };
+constexpr uint32_t Version = 1;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t entrySize;
+    uint64_t reserved[2];
+};
+
+static_assert(sizeof(FileHeader) == sizeof(TrainingEntry), "the header keeps entries aligned");
+
+bool validPiece(unsigned code) { return (code & 7) < 6 && code < 14; }
+
+} // namespace
+
+TrainingEntry packEntry(const BoardState& state, int score, Move best, int result) {
+    TrainingEntry e{};
+    e.occupied = state.occupied;
+    int n = 0;
+    for (Bitboard b = state.occupied; b && n < 32; ++n) {
+        Square sq = popLsb(b);
+        e.pieces[n >> 1] |= static_cast<uint8_t>(state.pieceAt(sq) << ((n & 1) * 4));
+    }
+    e.state = static_cast<uint8_t>(colorIndex(state.sideToMove) | state.castling << 1);
+    e.epSquare = state.epSquare;
+    e.halfmoveClock = state.halfmoveClock;
+    e.result = static_cast<int8_t>(result > 0 ? 1 : result < 0 ? -1 : 0);
+    e.score = static_cast<int16_t>(std::clamp(score, -32767, 32767));
+    e.move = best.raw();
+    return e;
+}
+
+bool unpackEntry(const TrainingEntry& e, BoardState& state) {
+    state.clear();
+    if (popCount(e.occupied) > 32) return false;
+    int n = 0;
+    for (Bitboard b = e.occupied; b; ++n) {
+        Square sq = popLsb(b);
+        unsigned code = (e.pieces[n >> 1] >> ((n & 1) * 4)) & 15;
+        if (!validPiece(code)) {
+            state.clear();
+            return false;
+        }
+        state.putPiece(pieceColor(static_cast<PieceCode>(code)), pieceType(static_cast<PieceCode>(code)), sq);
+    }
+    state.sideToMove = static_cast<PieceColor>(e.state & 1);
+    state.castling = (e.state >> 1) & AllCastling;
+    state.epSquare = e.epSquare <= NoSquare ? e.epSquare : NoSquare;
+    state.halfmoveClock = e.halfmoveClock;
+    state.key = state.computeKey();
+    if (popCount(state.bb(PieceColor::White, PieceType::King)) != 1
+        || popCount(state.bb(PieceColor::Black, PieceType::King)) != 1) {
+        state.clear();
+        return false;
+    }
+    return true;
+}
+
+bool TrainingWriter::open(const char* path) {
+    close();
+    file = std::fopen(path, "ab");
+    if (!file) return false;
+    batch.reserve(BatchSize);
+    std::fseek(file, 0, SEEK_END);
+    if (std::ftell(file) == 0) {
+        FileHeader header{};
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+        header.version = Version;
+        header.entrySize = sizeof(TrainingEntry);
+        std::fwrite(&header, sizeof(header), 1, file);
+    }
+    return true;
+}
+
+bool TrainingWriter::flush() {
+    if (!file) return false;
+    bool ok = std::fwrite(batch.data(), sizeof(TrainingEntry), batch.size(), file) == batch.size();
+    written += batch.size();
+    batch.clear();
+    return ok;
+}
+
+void TrainingWriter::close() {
+    if (!file) return;
+    flush();
+    std::fclose(file);
+    file = nullptr;
+    written = 0;
+}
+
+bool TrainingReader::open(const char* path) {
+    close();
+    if (!file.open(path) || file.size() < sizeof(FileHeader)) return false;
+    FileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) || header.version != Version
+        || header.entrySize != sizeof(TrainingEntry)) {
+        file.close();
+        return false;
+    }
+    entries = reinterpret_cast<const TrainingEntry*>(file.data() + sizeof(FileHeader));
+    count = (file.size() - sizeof(FileHeader)) / sizeof(TrainingEntry);
+    return true;
+}
+
+void TrainingReader::close() {
+    file.close();
+    entries = nullptr;
+    count = cursor = 0;
+    order.clear();
+}
+
+void TrainingReader::shuffle(uint64_t seed) {
+    order.resize(count);
+    for (size_t i = 0; i < count; ++i) order[i] = static_cast<uint32_t>(i);
+    // Fisher-Yates with a xorshift64* generator; the bound is applied with a
+    // multiply-high instead of a modulo.
+    uint64_t s = seed | 1;
+    for (size_t i = count; i > 1; --i) {
+        s ^= s >> 12;
+        s ^= s << 25;
+        s ^= s >> 27;
+        size_t j = static_cast<size_t>(mulHi64(s * 0x2545F4914F6CDD1DULL, i));
+        std::swap(order[i - 1], order[j]);
+    }
+    cursor = 0;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "boardstate.h"
+#include "mappedfile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// One training sample in 32 bytes: the occupancy bitboard, a 4-bit piece
+// code per occupied square in square order, the game state, and the search
+// score, best move and game result. The move counter is not stored.
+// Records are written in native (little-endian) byte order.
+struct TrainingEntry {
+    uint64_t occupied;
+    uint8_t pieces[16];     // two PieceCodes per byte, low nibble first
+    uint8_t state;          // bit 0 side to move, bits 1-4 castling rights
+    uint8_t epSquare;
+    uint8_t halfmoveClock;
+    int8_t result;          // 1 White won, 0 draw, -1 Black won
+    int16_t score;          // centipawns, from the side to move's view
+    uint16_t move;          // Move::raw() of the best move
+};
+
+static_assert(sizeof(TrainingEntry) == 32, "training entries are packed into 32 bytes");
+
+TrainingEntry packEntry(const BoardState& state, int score, Move best, int result);
+// False if the record does not decode to a position with both kings.
+bool unpackEntry(const TrainingEntry& entry, BoardState& state);
+
+// Appends entries to a training file, batching them into large writes. A
+// new file starts with a one-record header carrying the magic and version.
+class TrainingWriter {
+public:
+    TrainingWriter() = default;
+    ~TrainingWriter() { close(); }
+    TrainingWriter(const TrainingWriter&) = delete;
+    TrainingWriter& operator=(const TrainingWriter&) = delete;
+
+    bool open(const char* path);
+    void close();
+    bool isOpen() const { return file != nullptr; }
+
+    void write(const TrainingEntry& entry) {
+        batch.push_back(entry);
+        if (batch.size() == BatchSize) flush();
+    }
+    void write(const BoardState& state, int score, Move best, int result) {
+        write(packEntry(state, score, best, result));
+    }
+    bool flush();
+    uint64_t count() const { return written + batch.size(); }
+
+    static constexpr size_t BatchSize = 4096;
+
+private:
+    std::FILE* file = nullptr;
+    std::vector<TrainingEntry> batch;
+    uint64_t written = 0;
+};
+
+// Random access over a memory-mapped training file. next() walks the
+// entries either in file order or, after shuffle(), in a random permutation
+// that is redrawn per epoch without copying any records.
+class TrainingReader {
+public:
+    bool open(const char* path);
+    void close();
+    bool isOpen() const { return entries != nullptr; }
+
+    size_t size() const { return count; }
+    const TrainingEntry& operator[](size_t i) const { return entries[i]; }
+
+    void shuffle(uint64_t seed);
+    void rewind() { cursor = 0; }
+    const TrainingEntry* next() {
+        if (cursor == count) return nullptr;
+        size_t i = cursor++;
+        return &entries[order.empty() ? i : order[i]];
+    }
+
+private:
+    MappedFile file;
+    const TrainingEntry* entries = nullptr;
+    size_t count = 0;
+    size_t cursor = 0;
+    std::vector<uint32_t> order;
+};
@@ -0,0 +1,200 @@
+#include "tt.h"
+
+#include "search.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#if defined(__GNUC__)
+#define TT_PREFETCH(addr) __builtin_prefetch(addr)
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#define TT_PREFETCH(addr) _mm_prefetch(reinterpret_cast<const char*>(addr), _MM_HINT_T0)
+#else
+#define TT_PREFETCH(addr) ((void)(addr))
+#endif
+
+namespace {
+
+// Data word layout: move (16 bits), score (16), depth (8), bound (2), age (6);
+// the top 16 bits are unused.
+constexpr int DepthOffset = 16;
+
+uint64_t packData(Move move, int score, int depth, Bound bound, uint8_t age) {
+    return uint64_t(move.raw())
+        | uint64_t(static_cast<uint16_t>(static_cast<int16_t>(score))) << 16
+        | uint64_t(static_cast<uint8_t>(depth + DepthOffset)) << 32
+        | uint64_t(bound) << 40
+        | uint64_t(age) << 42;
+}
+
+Move dataMove(uint64_t d) { return Move::fromRaw(static_cast<uint16_t>(d)); }
+int dataScore(uint64_t d) { return static_cast<int16_t>(static_cast<uint16_t>(d >> 16)); }
+int dataDepth(uint64_t d) { return static_cast<int>((d >> 32) & 0xFF) - DepthOffset; }
+Bound dataBound(uint64_t d) { return static_cast<Bound>((d >> 40) & 3); }
+uint8_t dataAge(uint64_t d) { return static_cast<uint8_t>((d >> 42) & 63); }
+
+constexpr size_t LargePageSize = size_t(2) << 20;
+
+// Tries to back the table with large pages; falls back to ordinary,
+// cache-line-aligned memory when the OS refuses.
+void* allocateTable(size_t bytes, bool largePages, bool& gotLargePages) {
+    gotLargePages = false;
+#if defined(_WIN32)
+    if (largePages) {
+        HANDLE token;
+        if (OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token)) {
+            TOKEN_PRIVILEGES tp{};
+            if (LookupPrivilegeValue(nullptr, SE_LOCK_MEMORY_NAME, &tp.Privileges[0].Luid)) {
+                tp.PrivilegeCount = 1;
+                tp.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+                AdjustTokenPrivileges(token, FALSE, &tp, 0, nullptr, nullptr);
+            }
+            CloseHandle(token);
+        }
+        size_t pageSize = GetLargePageMinimum();
+        if (pageSize) {
+            size_t rounded = (bytes + pageSize - 1) / pageSize * pageSize;
+            void* p = VirtualAlloc(nullptr, rounded, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (p) {
+                gotLargePages = true;
+                return p;
+            }
+        }
+    }
+    return VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+    size_t rounded = (bytes + LargePageSize - 1) / LargePageSize * LargePageSize;
+    void* p = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) return nullptr;
+#if defined(MADV_HUGEPAGE)
+    if (largePages && madvise(p, rounded, MADV_HUGEPAGE) == 0) gotLargePages = true;
+#endif
+    return p;
+#endif
+}
+
+void freeTable(void* p, size_t bytes) {
+    if (!p) return;
+#if defined(_WIN32)
+    (void)bytes;
+    VirtualFree(p, 0, MEM_RELEASE);
+#else
+    munmap(p, (bytes + LargePageSize - 1) / LargePageSize * LargePageSize);
+#endif
+}
+
+} // namespace
+
+TranspositionTable::~TranspositionTable() {
+    release();
+}
+
+void TranspositionTable::release() {
+    freeTable(buckets, allocatedBytes);
+    buckets = nullptr;
+    bucketCount = 0;
+    allocatedBytes = 0;
+    largePagesInUse = false;
+}
+
+size_t TranspositionTable::resize(size_t megabytes, bool largePages) {
+    release();
+    if (megabytes == 0) megabytes = 1;
+    void* memory = nullptr;
+    while (!(memory = allocateTable(megabytes << 20, largePages, largePagesInUse)) && megabytes > 1)
+        megabytes /= 2;
+    if (!memory) throw std::bad_alloc();
+    buckets = static_cast<Bucket*>(memory);
+    allocatedBytes = megabytes << 20;
+    bucketCount = allocatedBytes / sizeof(Bucket);
+    // Fresh OS pages are already zero; a memset would only fault them all in.
+    generation = 0;
+    return megabytes;
+}
+
+void TranspositionTable::clear() {
+    // Fresh OS pages are already zero, but clear() is also used between games.
+    std::memset(static_cast<void*>(buckets), 0, bucketCount * sizeof(Bucket));
+    generation = 0;
+}
+
+void TranspositionTable::prefetch(uint64_t key) const {
+    TT_PREFETCH(&bucketFor(key));
+}
+
+bool TranspositionTable::probe(uint64_t key, TTData& out) const {
+    Bucket& bucket = bucketFor(key);
+    for (Entry& e : bucket.entries) {
+        uint64_t data = e.data.load(std::memory_order_relaxed);
+        if ((e.keyXorData.load(std::memory_order_relaxed) ^ data) != key || !data) continue;
+        out.move = dataMove(data);
+        out.score = dataScore(data);
+        out.depth = dataDepth(data);
+        out.bound = dataBound(data);
+        return true;
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, Move move, int score, int depth, Bound bound) {
+    Bucket& bucket = bucketFor(key);
+    Entry* replace = &bucket.entries[0];
+    int worst = 1 << 30;
+    for (Entry& e : bucket.entries) {
+        uint64_t data = e.data.load(std::memory_order_relaxed);
+        uint64_t stored = e.keyXorData.load(std::memory_order_relaxed) ^ data;
+        if (!data || stored == key) {
+            // Same position: keep the old best move if the new search has none,
+            // and do not let a much shallower non-exact result evict a deep one.
+            if (stored == key && data) {
+                if (move == NoMove) move = dataMove(data);
+                if (bound != BoundExact && depth + 4 < dataDepth(data) && dataAge(data) == generation) return;
+            }
+            replace = &e;
+            break;
+        }
+        // Depth-preferred with ageing: entries from older searches lose eight
+        // plies of priority per generation.
+        int age = (generation - dataAge(data)) & AgeMask;
+        int value = dataDepth(data) - 8 * age;
+        if (value < worst) {
+            worst = value;
+            replace = &e;
+        }
+    }
+    uint64_t data = packData(move, score, depth, bound, generation);
+    replace->data.store(data, std::memory_order_relaxed);
+    replace->keyXorData.store(key ^ data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const {
+    size_t sample = bucketCount < 250 ? bucketCount : 250;
+    int used = 0;
+    for (size_t i = 0; i < sample; ++i)
+        for (const Entry& e : buckets[i].entries) {
+            uint64_t data = e.data.load(std::memory_order_relaxed);
+            if (data && dataAge(data) == generation) ++used;
+        }
+    return sample ? static_cast<int>(used * 1000 / (sample * BucketSize)) : 0;
+}
+
+int scoreToTT(int score, int ply) {
+    if (score >= ValueTBWinInMaxPly) return score + ply;
+    if (score <= -ValueTBWinInMaxPly) return score - ply;
+    return score;
+}
+
+int scoreFromTT(int score, int ply) {
+    if (score >= ValueTBWinInMaxPly) return score - ply;
+    if (score <= -ValueTBWinInMaxPly) return score + ply;
+    return score;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "types.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+enum Bound : uint8_t {
+    BoundNone = 0,
+    BoundUpper = 1,
+    BoundLower = 2,
+    BoundExact = 3
+};
+
+struct TTData {
+    Move move;
+    int score;
+    int depth;
+    Bound bound;
+};
+
+// Shared by all search threads without locks. Each entry stores its data
+// word and the key XORed with that word; a torn write by a concurrent store
+// fails the XOR check and reads as a miss instead of returning mixed data.
+class TranspositionTable {
+public:
+    TranspositionTable() = default;
+    explicit TranspositionTable(size_t megabytes, bool largePages = false) { resize(megabytes, largePages); }
+    ~TranspositionTable();
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    // Reallocates the table empty; not safe while a search is running. When
+    // the size cannot be had, halves it until an allocation succeeds and
+    // returns the megabytes actually allocated. Throws std::bad_alloc only
+    // if not even one megabyte is available.
+    size_t resize(size_t megabytes, bool largePages = false);
+    void clear();
+    // Ages existing entries so that stale ones are replaced first.
+    void newSearch() { generation = static_cast<uint8_t>((generation + 1) & AgeMask); }
+
+    bool probe(uint64_t key, TTData& data) const;
+    void store(uint64_t key, Move move, int score, int depth, Bound bound);
+
+    // Permille of sampled entries written during the current search.
+    int hashfull() const;
+    size_t sizeMB() const { return bucketCount * sizeof(Bucket) >> 20; }
+    bool usesLargePages() const { return largePagesInUse; }
+
+    void prefetch(uint64_t key) const;
+
+private:
+    struct Entry {
+        std::atomic<uint64_t> keyXorData;
+        std::atomic<uint64_t> data;
+    };
+    static constexpr int BucketSize = 4;
+    struct alignas(64) Bucket {
+        Entry entries[BucketSize];
+    };
+    static_assert(sizeof(Bucket) == 64, "a bucket must fill exactly one cache line");
+
+    static constexpr uint8_t AgeMask = 63;
+
+    Bucket& bucketFor(uint64_t key) const {
+        // Multiply-shift maps the key onto any bucket count, not only powers of two.
+        return buckets[static_cast<size_t>(mulHi64(key, bucketCount))];
+    }
+    void release();
+
+    Bucket* buckets = nullptr;
+    size_t bucketCount = 0;
+    size_t allocatedBytes = 0;
+    bool largePagesInUse = false;
+    uint8_t generation = 0;
+};
+
+// Mate and tablebase scores are stored relative to the node, not the root,
+// so that they stay correct when the entry is reached through a different
+// path.
+int scoreToTT(int score, int ply);
+int scoreFromTT(int score, int ply);
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+enum class PieceColor : uint8_t { White, Black };
+enum class PieceType : uint8_t { King, Queen, Rook, Bishop, Knight, Pawn, None };
+
+struct Position {
+    int row;
+    int col;
+
+    bool isValid() const {
+        return row >= 0 && row < 8 && col >= 0 && col < 8;
+    }
+};
+
+// Packed piece code: colour in bit 3, type in bits 0-2. Empty squares hold
+// NoPiece, which decodes as a white PieceType::None like the Empty facade.
+using PieceCode = uint8_t;
+
+constexpr PieceCode NoPiece = static_cast<PieceCode>(PieceType::None);
+
+constexpr PieceCode makePiece(PieceColor c, PieceType t) {
+    return static_cast<PieceCode>(static_cast<int>(c) << 3 | static_cast<int>(t));
+}
+constexpr PieceType pieceType(PieceCode p) { return static_cast<PieceType>(p & 7); }
+constexpr PieceColor pieceColor(PieceCode p) { return static_cast<PieceColor>(p >> 3); }
+
+constexpr char PieceSymbols[17] = "KQRBNP. kqrbnp. ";
+constexpr char pieceSymbol(PieceCode p) { return PieceSymbols[p & 15]; }
+
+// Squares are numbered a1 = 0 ... h8 = 63. Position keeps the console layout
+// (row 0 is the eighth rank), so the two are converted at the Board boundary.
+using Square = int;
+using Bitboard = uint64_t;
+
+constexpr Square NoSquare = 64;
+
+constexpr int colorIndex(PieceColor c) { return static_cast<int>(c); }
+constexpr int typeIndex(PieceType t) { return static_cast<int>(t); }
+constexpr PieceColor operator~(PieceColor c) { return c == PieceColor::White ? PieceColor::Black : PieceColor::White; }
+
+constexpr Square makeSquare(int file, int rank) { return rank * 8 + file; }
+constexpr int fileOf(Square sq) { return sq & 7; }
+constexpr int rankOf(Square sq) { return sq >> 3; }
+constexpr Bitboard squareBB(Square sq) { return Bitboard(1) << sq; }
+
+inline Square toSquare(Position pos) { return makeSquare(pos.col, 7 - pos.row); }
+inline Position toPosition(Square sq) { return { 7 - rankOf(sq), fileOf(sq) }; }
+
+inline int popCount(Bitboard b) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    return static_cast<int>(__popcnt64(b));
+#elif defined(__GNUC__)
+    return __builtin_popcountll(b);
+#else
+    int n = 0;
+    for (; b; b &= b - 1) ++n;
+    return n;
+#endif
+}
+
+// Index of the least significant set bit; b must be non-zero.
+inline Square lsb(Bitboard b) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long idx;
+    _BitScanForward64(&idx, b);
+    return static_cast<Square>(idx);
+#elif defined(_MSC_VER)
+    unsigned long idx;
+    if (static_cast<uint32_t>(b)) {
+        _BitScanForward(&idx, static_cast<uint32_t>(b));
+        return static_cast<Square>(idx);
+    }
+    _BitScanForward(&idx, static_cast<uint32_t>(b >> 32));
+    return static_cast<Square>(idx + 32);
+#else
+    return __builtin_ctzll(b);
+#endif
+}
+
+inline Square popLsb(Bitboard& b) {
+    Square sq = lsb(b);
+    b &= b - 1;
+    return sq;
+}
+
+// High 64 bits of the 128-bit product a * b.
+inline uint64_t mulHi64(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return __umulh(a, b);
+#else
+    uint64_t aLo = static_cast<uint32_t>(a), aHi = a >> 32;
+    uint64_t bLo = static_cast<uint32_t>(b), bHi = b >> 32;
+    uint64_t mid = aHi * bLo + ((aLo * bLo) >> 32);
+    uint64_t mid2 = aLo * bHi + static_cast<uint32_t>(mid);
+    return aHi * bHi + (mid >> 32) + (mid2 >> 32);
+#endif
+}
+
+enum MoveFlag : uint8_t {
+    QuietMove = 0,
+    CaptureMove = 1,
+    DoublePush = 2,
+    PromotionMove = 4,
+    EnPassantMove = 8,
+    CastlingMove = 16
+};
+
+// 16-bit move: from (bits 0-5), to (6-11) and a 4-bit kind (12-15).
+// Kinds: 0 quiet, 1 double push, 2 castling, 4 capture, 5 en passant,
+// 8-11 promotion to knight/bishop/rook/queen, 12-15 the same with capture.
+// The kind expands to MoveFlag bits through a table, so callers test
+// flags() exactly as they would a stored flag byte.
+class Move {
+public:
+    constexpr Move() = default;
+    constexpr Move(Square from, Square to, uint8_t flags = QuietMove, PieceType promotion = PieceType::None)
+        : data(static_cast<uint16_t>(from | to << 6 | kindOf(flags, promotion) << 12)) {}
+
+    constexpr Square from() const { return data & 63; }
+    constexpr Square to() const { return (data >> 6) & 63; }
+    constexpr uint8_t flags() const { return KindFlags[data >> 12]; }
+    constexpr PieceType promotion() const {
+        return (data & 0x8000) ? static_cast<PieceType>(typeIndex(PieceType::Knight) - ((data >> 12) & 3)) : PieceType::None;
+    }
+    constexpr uint16_t raw() const { return data; }
+    static constexpr Move fromRaw(uint16_t raw) {
+        Move m;
+        m.data = raw;
+        return m;
+    }
+
+    constexpr bool operator==(const Move& m) const { return data == m.data; }
+    constexpr bool operator!=(const Move& m) const { return data != m.data; }
+
+private:
+    static constexpr uint8_t kindOf(uint8_t flags, PieceType promotion) {
+        if (flags & PromotionMove)
+            return static_cast<uint8_t>(8 | ((flags & CaptureMove) ? 4 : 0) | (typeIndex(PieceType::Knight) - typeIndex(promotion)));
+        if (flags & EnPassantMove) return 5;
+        if (flags & CastlingMove) return 2;
+        if (flags & CaptureMove) return 4;
+        return (flags & DoublePush) ? 1 : 0;
+    }
+
+    static constexpr uint8_t KindFlags[16] = {
+        QuietMove, DoublePush, CastlingMove, 0, CaptureMove, CaptureMove | EnPassantMove, 0, 0,
+        PromotionMove, PromotionMove, PromotionMove, PromotionMove,
+        PromotionMove | CaptureMove, PromotionMove | CaptureMove, PromotionMove | CaptureMove, PromotionMove | CaptureMove
+    };
+
+    uint16_t data = 0;
+};
+
+static_assert(sizeof(Move) == 2, "moves are packed into 16 bits");
+
+constexpr Move NoMove{};
+
+// Castling right bits.
+enum : uint8_t {
+    WhiteKingSide = 1,
+    WhiteQueenSide = 2,
+    BlackKingSide = 4,
+    BlackQueenSide = 8,
+    AllCastling = 15
+};
@@ -0,0 +1,297 @@
+#include "uci.h"
+
+#include "movegen.h"
+#include "tablebase.h"
+
+#include <algorithm>
+#include <charconv>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+// Bounds of the spin options, as advertised in reply to "uci".
+struct SpinOption {
+    const char* name;
+    int64_t defaultValue;
+    int64_t min;
+    int64_t max;
+};
+
+constexpr SpinOption HashOption = { "Hash", 16, 1, 65536 };
+constexpr SpinOption ThreadsOption = { "Threads", 1, 1, 512 };
+constexpr SpinOption OverheadOption = { "Move Overhead", DefaultMoveOverheadMs, 0, 5000 };
+
+std::string describe(const SpinOption& o) {
+    return std::string("option name ") + o.name + " type spin default " + std::to_string(o.defaultValue)
+        + " min " + std::to_string(o.min) + " max " + std::to_string(o.max);
+}
+
+// Parses a spin value and clamps it to the option's range; false if the
+// text is not a number.
+bool parseSpin(const std::string& text, const SpinOption& o, int64_t& value) {
+    const char* end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, value);
+    if (ec != std::errc() || ptr != end) return false;
+    value = std::clamp(value, o.min, o.max);
+    return true;
+}
+
+// Tablebase wins are reported like other engines do: as a fixed, clearly
+// decisive centipawn value less the plies to the probed position, never as
+// the internal score band.
+constexpr int TBWinCentipawns = 20000;
+
+std::string scoreToString(int score) {
+    if (score >= ValueMateInMaxPly) return "mate " + std::to_string((ValueMate - score + 1) / 2);
+    if (score <= -ValueMateInMaxPly) return "mate " + std::to_string(-(ValueMate + score) / 2);
+    if (score >= ValueTBWinInMaxPly) return "cp " + std::to_string(TBWinCentipawns - (ValueTBWin - score));
+    if (score <= -ValueTBWinInMaxPly) return "cp " + std::to_string(-TBWinCentipawns + (ValueTBWin + score));
+    return "cp " + std::to_string(score);
+}
+
+// Finds the legal move written in coordinate notation, or NoMove.
+Move parseMove(const BoardState& state, const std::string& text) {
+    MoveList moves;
+    generateLegalMoves(state, moves);
+    for (const Move& m : moves)
+        if (moveToString(m) == text) return m;
+    return NoMove;
+}
+
+} // namespace
+
+UciEngine::UciEngine(size_t hashMB, bool largePages, int threads, const std::string& evalFile,
+                     const std::string& bookFile)
+    : evaluator(makeEvaluator(evalFile)), tt(hashMB, largePages), pool(*evaluator, tt, threads),
+      largePages(largePages) {
+    root.setStartPosition();
+    if (!bookFile.empty()) book.open(bookFile.c_str());
+    pool.onIteration = [this](const SearchInfo& info) { sendInfo(info); };
+    pool.onFinished = [this](const SearchResult& result) {
+        if (reportStats) send("info string " + result.stats.describe());
+        std::lock_guard<std::mutex> lock(searchMutex);
+        searchDone = true;
+        pendingResult = result;
+        // "go infinite" and "go ponder" must not answer before stop/ponderhit.
+        if (!holdBestMove && !bestMoveSent) {
+            bestMoveSent = true;
+            sendBestMove(result);
+        }
+    };
+}
+
+void UciEngine::send(const std::string& line) {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cout << line << std::endl;
+}
+
+void UciEngine::sendInfo(const SearchInfo& info) {
+    uint64_t nodes = pool.nodesSearched();
+    std::ostringstream out;
+    out << "info depth " << info.depth << " score " << scoreToString(info.score)
+        << " nodes " << nodes << " nps " << (info.timeMs > 0 ? nodes * 1000 / info.timeMs : nodes)
+        << " time " << info.timeMs << " hashfull " << tt.hashfull() << " pv";
+    for (const Move& m : info.pv) out << ' ' << moveToString(m);
+    send(out.str());
+}
+
+void UciEngine::sendBestMove(const SearchResult& result) {
+    std::string line = "bestmove " + (result.bestMove == NoMove ? std::string("0000") : moveToString(result.bestMove));
+    if (result.pv.size() > 1) line += " ponder " + moveToString(result.pv[1]);
+    send(line);
+}
+
+void UciEngine::run(std::istream& in) {
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream ss(line);
+        std::string cmd;
+        ss >> cmd;
+        std::string args;
+        std::getline(ss >> std::ws, args);
+
+        if (cmd == "uci") {
+            send("id name chess1");
+            send("id author chess1 contributors");
+            send(describe(HashOption));
+            send(describe(ThreadsOption));
+            send("option name Clear Hash type button");
+            send("option name Ponder type check default false");
+            send(describe(OverheadOption));
+            send("option name EvalFile type string default <empty>");
+            send("option name BookFile type string default <empty>");
+            send("option name SyzygyPath type string default <empty>");
+            if (SearchStats::Enabled) send("option name SearchStats type check default false");
+            for (const SearchFeatures::Toggle& t : SearchFeatures::Toggles)
+                send(std::string("option name ") + t.name + " type check default true");
+            send("uciok");
+        }
+        else if (cmd == "isready") send("readyok");
+        else if (cmd == "ucinewgame") {
+            stopSearch();
+            pool.wait();
+            tt.clear();
+            pool.clearHistory();
+        }
+        else if (cmd == "position") {
+            stopSearch();
+            pool.wait();
+            position(args);
+        }
+        else if (cmd == "go") go(args);
+        else if (cmd == "stop") stopSearch();
+        else if (cmd == "ponderhit") ponderhit();
+        else if (cmd == "setoption") setOption(args);
+        else if (cmd == "quit") break;
+    }
+    stopSearch();
+    pool.wait();
+}
+
+void UciEngine::stopSearch() {
+    pool.stop();
+    std::lock_guard<std::mutex> lock(searchMutex);
+    holdBestMove = false;
+    if (searchDone && !bestMoveSent) {
+        bestMoveSent = true;
+        sendBestMove(pendingResult);
+    }
+}
+
+void UciEngine::ponderhit() {
+    // The predicted move was played: the ponder search keeps going on our
+    // clock, and a search that already finished answers now.
+    pool.ponderhit();
+    std::lock_guard<std::mutex> lock(searchMutex);
+    holdBestMove = false;
+    if (searchDone && !bestMoveSent) {
+        bestMoveSent = true;
+        sendBestMove(pendingResult);
+    }
+}
+
+void UciEngine::position(const std::string& args) {
+    std::istringstream ss(args);
+    std::string token;
+    ss >> token;
+    if (token == "startpos") {
+        root.setStartPosition();
+        ss >> token;
+    }
+    else if (token == "fen") {
+        std::string fen;
+        while (ss >> token && token != "moves") fen += token + " ";
+        if (!root.setFEN(fen.c_str())) {
+            send("info string invalid FEN: " + fen);
+            root.setStartPosition();
+        }
+    }
+    history.clear();
+    history.push(root.key);
+    if (token != "moves") return;
+    while (ss >> token) {
+        Move m = parseMove(root, token);
+        if (m == NoMove) {
+            send("info string illegal move: " + token);
+            return;
+        }
+        root.makeMove(m);
+        history.push(root.key);
+    }
+}
+
+void UciEngine::go(const std::string& args) {
+    stopSearch();
+    pool.wait();
+
+    std::istringstream ss(args);
+    std::string token;
+    SearchLimits limits;
+    int64_t time[2] = { 0, 0 }, inc[2] = { 0, 0 };
+    int movesToGo = 0;
+    bool infinite = false;
+    while (ss >> token) {
+        if (token == "wtime") ss >> time[0];
+        else if (token == "btime") ss >> time[1];
+        else if (token == "winc") ss >> inc[0];
+        else if (token == "binc") ss >> inc[1];
+        else if (token == "movestogo") ss >> movesToGo;
+        else if (token == "movetime") ss >> limits.movetimeMs;
+        else if (token == "depth") ss >> limits.depth;
+        else if (token == "nodes") ss >> limits.nodes;
+        else if (token == "infinite") infinite = true;
+        else if (token == "ponder") limits.ponder = true;
+    }
+
+    // A book hit answers at once; analysis and pondering always search.
+    if (!infinite && !limits.ponder) {
+        Move bookMove = book.probe(root);
+        if (bookMove != NoMove) {
+            send("bestmove " + moveToString(bookMove));
+            return;
+        }
+    }
+
+    int us = colorIndex(root.sideToMove);
+    if (!infinite) {
+        limits.timeMs = time[us];
+        limits.incrementMs = inc[us];
+        limits.movesToGo = movesToGo;
+        limits.overheadMs = moveOverheadMs;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(searchMutex);
+        holdBestMove = infinite || limits.ponder;
+        searchDone = false;
+        bestMoveSent = false;
+    }
+    pool.start(root, limits, &history);
+}
+
+void UciEngine::setOption(const std::string& args) {
+    std::istringstream ss(args);
+    std::string token, name, value;
+    ss >> token;   // "name"
+    while (ss >> token && token != "value") name += (name.empty() ? "" : " ") + token;
+    std::getline(ss >> std::ws, value);
+
+    stopSearch();
+    pool.wait();
+    int64_t number = 0;
+    for (const SpinOption* o : { &HashOption, &ThreadsOption, &OverheadOption })
+        if (name == o->name && !parseSpin(value, *o, number)) {
+            send("info string invalid value for " + name + ": " + value);
+            return;
+        }
+    if (name == HashOption.name) {
+        size_t allocated = tt.resize(static_cast<size_t>(number), largePages);
+        if (allocated != static_cast<size_t>(number))
+            send("info string Hash reduced to " + std::to_string(allocated) + " MB, not enough memory");
+    }
+    else if (name == ThreadsOption.name) pool.setThreadCount(static_cast<int>(number));
+    else if (name == "Clear Hash") tt.clear();
+    else if (name == "Ponder") {}   // the GUI decides when to send "go ponder"
+    else if (name == OverheadOption.name) moveOverheadMs = number;
+    else if (name == "SearchStats") reportStats = value == "true";
+    else if (features.set(name, value == "true")) pool.setFeatures(features);
+    else if (name == "SyzygyPath") {
+        Tablebases::init(value);
+        send("info string found " + std::to_string(Tablebases::tableCount()) + " tablebases");
+    }
+    else if (name == "BookFile") {
+        book.close();
+        if (value != "<empty>" && !value.empty() && !book.open(value.c_str()))
+            send("info string cannot open book " + value);
+    }
+    else if (name == "EvalFile") {
+        bool usedNetwork = false;
+        std::string path = value == "<empty>" ? std::string() : value;
+        evaluator = makeEvaluator(path, &usedNetwork);
+        pool.setEvaluator(*evaluator);
+        if (usedNetwork) send(std::string("info string NNUE evaluation with ") + Nnue::simdName() + " kernels");
+        else if (!path.empty()) send("info string cannot load network " + path + ", using handcrafted evaluation");
+    }
+    else send("info string unknown option: " + name);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "boardstate.h"
+#include "book.h"
+#include "evaluate.h"
+#include "nnue.h"
+#include "thread.h"
+#include "tt.h"
+
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Universal Chess Interface front-end. The calling thread only parses
+// commands; searches run asynchronously on the SearchPool workers, so
+// stop, isready and ponderhit are answered while a search is in progress.
+class UciEngine {
+public:
+    UciEngine(size_t hashMB, bool largePages, int threads, const std::string& evalFile = "",
+              const std::string& bookFile = "");
+    // Reads commands from in until "quit" or end of input.
+    void run(std::istream& in);
+
+private:
+    void send(const std::string& line);
+    void sendInfo(const SearchInfo& info);
+    void sendBestMove(const SearchResult& result);
+
+    void position(const std::string& args);
+    void go(const std::string& args);
+    void setOption(const std::string& args);
+    void stopSearch();
+    void ponderhit();
+
+    std::unique_ptr<Evaluator> evaluator;
+    TranspositionTable tt;
+    SearchPool pool;
+    OpeningBook book;
+    BoardState root;
+    KeyHistory history;   // keys from the "position" command's base to root
+    bool largePages;
+    int64_t moveOverheadMs = DefaultMoveOverheadMs;
+    bool reportStats = false;   // "info string" counter dump after each search
+    SearchFeatures features;
+
+    std::mutex outputMutex;
+    // Guards the "bestmove may be sent" state shared with the worker that
+    // finishes the search.
+    std::mutex searchMutex;
+    bool holdBestMove = false;
+    bool searchDone = false;
+    bool bestMoveSent = true;
+    SearchResult pendingResult;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "types.h"
+
+#include <array>
+
+// Zobrist keys, generated at compile time from a fixed-seed splitmix64
+// stream so that hashes are identical across builds and runs.
+namespace Zobrist {
+
+constexpr uint64_t splitmix64(uint64_t& s) {
+    uint64_t z = (s += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+struct Keys {
+    uint64_t psq[2][6][64];
+    uint64_t castling[16];
+    uint64_t enPassant[8];
+    uint64_t side;
+};
+
+constexpr Keys generate() {
+    Keys k{};
+    uint64_t s = 1070372;
+    for (auto& color : k.psq)
+        for (auto& type : color)
+            for (uint64_t& key : type) key = splitmix64(s);
+    for (uint64_t& key : k.enPassant) key = splitmix64(s);
+    k.side = splitmix64(s);
+    // One key per right; combinations are their XOR, so a single lookup
+    // replaces the rights that changed.
+    uint64_t rights[4] = { splitmix64(s), splitmix64(s), splitmix64(s), splitmix64(s) };
+    for (int cr = 0; cr < 16; ++cr)
+        for (int i = 0; i < 4; ++i)
+            if (cr & (1 << i)) k.castling[cr] ^= rights[i];
+    return k;
+}
+
+inline constexpr Keys keys = generate();
+
+inline uint64_t piece(PieceColor c, PieceType t, Square sq) { return keys.psq[colorIndex(c)][typeIndex(t)][sq]; }
+inline uint64_t castling(uint8_t rights) { return keys.castling[rights]; }
+inline uint64_t enPassant(Square sq) { return keys.enPassant[fileOf(sq)]; }
+inline uint64_t side() { return keys.side; }
+
+} // namespace Zobrist